@@ -0,0 +1,123 @@
+// AST allocation benchmark. Generates a program, lexes and parses it into
+// an ASTContext while counting heap allocations, and times releasing the
+// tree again.
+//
+//   ram-bench-astalloc [-functions=N] [-runs=R] [-o=<file>]
+//
+// -o also writes the program out, so that `ram-compiler -syntax-only
+// -frontend-stats <file>` can time the same input at any commit.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "astcontext.h"
+#include "lexer.h"
+#include "parser.h"
+#include "sourcemanager.h"
+
+namespace cl = llvm::cl;
+
+static cl::opt<unsigned> numFunctions("functions", cl::desc("Functions in the program"),
+                                      cl::init(50000));
+static cl::opt<unsigned> runs("runs", cl::desc("Runs; the best is reported"), cl::init(3));
+static cl::opt<std::string> outputFilename("o", cl::desc("Also write the program to <file>"),
+                                           cl::value_desc("file"), cl::init(""));
+
+static std::atomic<size_t> heapAllocations{0};
+
+void *operator new(size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+namespace {
+// About 20 lines per function, with the mix of statements and expressions
+// the samples use.
+std::string makeProgram() {
+    std::string text;
+    for (unsigned i = 0; i < numFunctions; ++i) {
+        std::string n = std::to_string(i);
+        text += "func f" + n + "(a: int, b: float, s: string): int {\n"
+                "    int x = a * 3 + " + n + ";\n"
+                "    float y = b / 2.5;\n"
+                "    int count = 0;\n"
+                "    while (count < x) {\n"
+                "        if (count == 4) {\n"
+                "            print(s, count);\n"
+                "        } else {\n"
+                "            x = x - 1;\n"
+                "        }\n"
+                "        count = count + 1;\n"
+                "    }\n"
+                "    if (a > 10 && x < 100) {\n"
+                "        print(\"big\");\n"
+                "    }\n"
+                "    x = x + f" + std::to_string(i / 2) + "(a, y, s);\n"
+                "    return x;\n"
+                "}\n\n";
+    }
+    text += "func main(): void {\n    print(f0(1, 2.0, \"s\"));\n}\n";
+    return text;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+}
+
+int main(int argc, const char **argv) {
+    cl::ParseCommandLineOptions(argc, argv, "AST allocation benchmark\n");
+
+    std::string text = makeProgram();
+    if (!outputFilename.empty())
+        std::ofstream(outputFilename) << text;
+    SourceManager sourceManager;
+    const SourceFile &file = sourceManager.addFile(
+        "generated.al", llvm::MemoryBuffer::getMemBufferCopy(text, "generated.al"));
+
+    double bestParse = 1e30, bestRelease = 1e30;
+    size_t allocations = 0, nodes = 0, arena = 0, functions = 0;
+    for (unsigned run = 0; run < runs; ++run) {
+        auto context = std::make_unique<ASTContext>();
+        size_t allocationsBefore = heapAllocations.load();
+        auto parseStart = std::chrono::steady_clock::now();
+        {
+            TheLexer lexer{sourceManager, file};
+            Parser parser(lexer, *context);
+            functions = parser.parseProgram().size();
+        }
+        bestParse = std::min(bestParse, secondsSince(parseStart));
+        allocations = heapAllocations.load() - allocationsBefore;
+        nodes = context->getNumNodes();
+        arena = context->getTotalMemory();
+
+        auto releaseStart = std::chrono::steady_clock::now();
+        context.reset();
+        bestRelease = std::min(bestRelease, secondsSince(releaseStart));
+    }
+
+    std::cout << "program: " << functions << " functions, " << text.size() / (1 << 20)
+              << " MB, " << nodes << " nodes\n"
+              << "lex+parse: " << bestParse * 1000 << " ms (" << nodes / bestParse / 1e6
+              << " M nodes/s)\n"
+              << "heap allocations while parsing: " << allocations << " ("
+              << static_cast<double>(allocations) / nodes << " per node)\n"
+              << "arena: " << arena / (1 << 20) << " MB\n"
+              << "release: " << bestRelease * 1000 << " ms\n";
+    return 0;
+}
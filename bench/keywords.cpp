@@ -0,0 +1,124 @@
+// Keyword recognition benchmark. Classifies a generated corpus of words
+// with the lexer's perfect hash and with the chain of string compares it
+// replaced, then lexes the same words as one file.
+//
+//   ram-bench-keywords [-words=N] [-keyword-percent=P] [-runs=R]
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "lexer.h"
+#include "sourcemanager.h"
+#include "token.h"
+
+namespace cl = llvm::cl;
+
+static cl::opt<unsigned> numWords("words", cl::desc("Words in the corpus"), cl::init(2000000));
+static cl::opt<unsigned> keywordPercent("keyword-percent",
+                                        cl::desc("Share of the words that are keywords"),
+                                        cl::init(15));
+static cl::opt<unsigned> runs("runs", cl::desc("Runs per measurement; the best is reported"),
+                              cl::init(5));
+
+namespace {
+constexpr std::string_view keywordSpellings[] = {
+#define KEYWORD(kind, spelling, name) spelling,
+    TOKEN_KEYWORDS(KEYWORD)
+#undef KEYWORD
+};
+
+// What the lexer did before the perfect hash: one compare per keyword.
+TokenKind classifyByChain(std::string_view id) {
+#define KEYWORD(kind, spelling, name) if (id == spelling) return TokenKind::kind;
+    TOKEN_KEYWORDS(KEYWORD)
+#undef KEYWORD
+    return TokenKind::identifier;
+}
+
+std::vector<std::string> makeCorpus() {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<unsigned> percent(0, 99);
+    std::uniform_int_distribution<size_t> keyword(0, std::size(keywordSpellings) - 1);
+    std::uniform_int_distribution<int> length(1, 12);
+    std::uniform_int_distribution<int> letter(0, 25);
+    std::vector<std::string> words;
+    words.reserve(numWords);
+    for (unsigned i = 0; i < numWords; ++i) {
+        if (percent(rng) < keywordPercent) {
+            words.emplace_back(keywordSpellings[keyword(rng)]);
+            continue;
+        }
+        std::string word;
+        for (int n = length(rng); n > 0; --n)
+            word += static_cast<char>('a' + letter(rng));
+        words.push_back(std::move(word));
+    }
+    return words;
+}
+
+// Best wall-clock time of `runs` calls to `fn`, in seconds.
+template <typename Fn>
+double best(Fn fn) {
+    double best = 1e30;
+    for (unsigned i = 0; i < runs; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double>(
+                                  std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+}
+
+int main(int argc, const char **argv) {
+    cl::ParseCommandLineOptions(argc, argv, "Keyword recognition benchmark\n");
+
+    std::vector<std::string> words = makeCorpus();
+    std::vector<std::string_view> views(words.begin(), words.end());
+    for (std::string_view word : views) {
+        if (classifyIdentifier(word) != classifyByChain(word)) {
+            std::cerr << "mismatch on '" << word << "'\n";
+            return 1;
+        }
+    }
+
+    unsigned checksum = 0;
+    auto classifyAll = [&](TokenKind (*classify)(std::string_view)) {
+        unsigned sum = 0;
+        for (std::string_view word : views)
+            sum += static_cast<unsigned>(classify(word));
+        checksum += sum;
+    };
+    double hashTime = best([&] { classifyAll(classifyIdentifier); });
+    double chainTime = best([&] { classifyAll(classifyByChain); });
+
+    std::string text;
+    for (size_t i = 0; i < words.size(); ++i) {
+        text += words[i];
+        text += i % 10 == 9 ? '\n' : ' ';
+    }
+    SourceManager sourceManager;
+    const SourceFile &sourceFile = sourceManager.addFile(
+        "keywords.al", llvm::MemoryBuffer::getMemBufferCopy(text, "keywords.al"));
+    double lexTime = best([&] {
+        TheLexer lexer{sourceManager, sourceFile};
+        while (lexer.getNextToken().kind != TokenKind::eof)
+            ++checksum;
+    });
+
+    double mwords = words.size() / 1e6;
+    std::cout << "corpus: " << words.size() << " words, " << keywordPercent << "% keywords, "
+              << text.size() / 1024 << " KB (checksum " << checksum << ")\n"
+              << "perfect hash:  " << mwords / hashTime << " M words/s\n"
+              << "compare chain: " << mwords / chainTime << " M words/s\n"
+              << "lexer:         " << text.size() / lexTime / 1e6 << " MB/s\n";
+    return 0;
+}
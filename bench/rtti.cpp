@@ -0,0 +1,268 @@
+// Node type test benchmark. Classifies every statement and expression of a
+// generated program the way sema did with dynamic_cast on the old virtual
+// hierarchy, mirrored here, and by switching on the kind tag; then times
+// sema itself and prints the node sizes.
+//
+//   ram-bench-rtti [-functions=N] [-statements=N] [-runs=R] [-o=<file>]
+//
+// -o also writes the program out, so that `ram-compiler -frontend-stats
+// <file>` can time sema on the same input at any commit.
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "ast.h"
+#include "astcontext.h"
+#include "lexer.h"
+#include "parser.h"
+#include "sema.h"
+#include "sourcemanager.h"
+
+namespace cl = llvm::cl;
+
+static cl::opt<unsigned> numFunctions("functions", cl::desc("Functions in the program"),
+                                      cl::init(2000));
+static cl::opt<unsigned> numStatements("statements", cl::desc("Statements per function"),
+                                       cl::init(40));
+static cl::opt<unsigned> runs("runs", cl::desc("Runs; the best is reported"), cl::init(5));
+static cl::opt<std::string> outputFilename("o", cl::desc("Also write the program to <file>"),
+                                           cl::value_desc("file"), cl::init(""));
+
+namespace legacy {
+// The shape of the hierarchy before kind tags: a vtable in every node,
+// virtual inheritance of ASTNode, and VariableDecl both a Stmt and a Decl.
+struct ASTNode { virtual ~ASTNode() = default; };
+struct Stmt : virtual ASTNode {};
+struct Decl : virtual ASTNode {};
+struct Expr : Stmt {};
+struct ReturnStmt : Stmt {};
+struct IfStmt : Stmt {};
+struct WhileStmt : Stmt {};
+struct VariableDecl : Stmt, Decl {};
+struct PrintExpr : Expr {};
+struct NumberLiteral : Expr {};
+struct StringLiteral : Expr {};
+struct BooleanLiteral : Expr {};
+struct DeclRefExpr : Expr {};
+struct CallExpr : Expr {};
+struct BinaryExpr : Expr {};
+struct AssignmentExpr : Expr {};
+
+std::unique_ptr<Stmt> mirror(NodeKind kind) {
+    switch (kind) {
+        case NodeKind::ReturnStmt: return std::make_unique<ReturnStmt>();
+        case NodeKind::IfStmt: return std::make_unique<IfStmt>();
+        case NodeKind::WhileStmt: return std::make_unique<WhileStmt>();
+        case NodeKind::VariableDecl: return std::make_unique<VariableDecl>();
+        case NodeKind::PrintExpr: return std::make_unique<PrintExpr>();
+        case NodeKind::NumberLiteral: return std::make_unique<NumberLiteral>();
+        case NodeKind::StringLiteral: return std::make_unique<StringLiteral>();
+        case NodeKind::BooleanLiteral: return std::make_unique<BooleanLiteral>();
+        case NodeKind::DeclRefExpr: return std::make_unique<DeclRefExpr>();
+        case NodeKind::CallExpr: return std::make_unique<CallExpr>();
+        case NodeKind::BinaryExpr: return std::make_unique<BinaryExpr>();
+        case NodeKind::AssignmentExpr: return std::make_unique<AssignmentExpr>();
+        default: return nullptr;
+    }
+}
+
+// The order sema tested statement and expression classes in.
+unsigned classify(Stmt &stmt) {
+    if (dynamic_cast<ReturnStmt *>(&stmt)) return 1;
+    if (dynamic_cast<IfStmt *>(&stmt)) return 2;
+    if (dynamic_cast<WhileStmt *>(&stmt)) return 3;
+    if (dynamic_cast<VariableDecl *>(&stmt)) return 4;
+    if (auto *expr = dynamic_cast<Expr *>(&stmt)) {
+        if (dynamic_cast<StringLiteral *>(expr)) return 5;
+        if (dynamic_cast<NumberLiteral *>(expr)) return 6;
+        if (dynamic_cast<BooleanLiteral *>(expr)) return 7;
+        if (dynamic_cast<DeclRefExpr *>(expr)) return 8;
+        if (dynamic_cast<PrintExpr *>(expr)) return 9;
+        if (dynamic_cast<CallExpr *>(expr)) return 10;
+        if (dynamic_cast<BinaryExpr *>(expr)) return 11;
+        if (dynamic_cast<AssignmentExpr *>(expr)) return 12;
+    }
+    return 0;
+}
+}
+
+namespace {
+unsigned classify(Stmt &stmt) {
+    switch (stmt.getKind()) {
+        case NodeKind::ReturnStmt: return 1;
+        case NodeKind::IfStmt: return 2;
+        case NodeKind::WhileStmt: return 3;
+        case NodeKind::VariableDecl: return 4;
+        case NodeKind::StringLiteral: return 5;
+        case NodeKind::NumberLiteral: return 6;
+        case NodeKind::BooleanLiteral: return 7;
+        case NodeKind::DeclRefExpr: return 8;
+        case NodeKind::PrintExpr: return 9;
+        case NodeKind::CallExpr: return 10;
+        case NodeKind::BinaryExpr: return 11;
+        case NodeKind::AssignmentExpr: return 12;
+        default: return 0;
+    }
+}
+
+// Every statement and expression under a function, in the order sema
+// visits them.
+class CollectStmts : public ASTVisitor<CollectStmts> {
+public:
+    std::vector<Stmt *> stmts;
+
+    void visitBlock(Block &node) {
+        for (Stmt *stmt : node.statements) visit(*stmt);
+    }
+    void visitFunctionDecl(FunctionDecl &node) {
+        if (node.body) visit(*node.body);
+    }
+    void visitStmt(Stmt &node) { stmts.push_back(&node); }
+    void visitReturnStmt(ReturnStmt &node) {
+        stmts.push_back(&node);
+        if (node.expr) visit(*node.expr);
+    }
+    void visitIfStmt(IfStmt &node) {
+        stmts.push_back(&node);
+        visit(*node.condition);
+        visit(*node.thenBlock);
+        if (node.elseBlock) visit(*node.elseBlock);
+    }
+    void visitWhileStmt(WhileStmt &node) {
+        stmts.push_back(&node);
+        visit(*node.condition);
+        visit(*node.body);
+    }
+    void visitVariableDecl(VariableDecl &node) {
+        stmts.push_back(&node);
+        if (node.initializer) visit(*node.initializer);
+    }
+    void visitPrintExpr(PrintExpr &node) {
+        stmts.push_back(&node);
+        for (Expr *arg : node.args) visit(*arg);
+    }
+    void visitCallExpr(CallExpr &node) {
+        stmts.push_back(&node);
+        for (Expr *arg : node.arguments) visit(*arg);
+    }
+    void visitBinaryExpr(BinaryExpr &node) {
+        stmts.push_back(&node);
+        visit(*node.left);
+        visit(*node.right);
+    }
+    void visitAssignmentExpr(AssignmentExpr &node) {
+        stmts.push_back(&node);
+        visit(*node.value);
+    }
+};
+
+std::string makeProgram() {
+    std::string text;
+    for (unsigned i = 0; i < numFunctions; ++i) {
+        text += "func f" + std::to_string(i) + "(a: int, b: int): int {\n"
+                "    int x = a + b * 2;\n";
+        for (unsigned s = 1; s + 1 < numStatements; ++s) {
+            std::string v = "v" + std::to_string(s);
+            switch (s % 5) {
+                case 0: text += "    int " + v + " = x * " + std::to_string(s) + " + a;\n"; break;
+                case 1: text += "    x = x + (a - " + std::to_string(s) + ") * b;\n"; break;
+                case 2: text += "    if (x > " + std::to_string(s) + ") { x = x - 1; } else { print(x); }\n"; break;
+                case 3: text += "    while (x < a) { x = x + 1; }\n"; break;
+                case 4: text += "    print(\"step\", x, a == b);\n"; break;
+            }
+        }
+        text += "    return x;\n}\n\n";
+    }
+    text += "func main(): void {\n    print(f0(1, 2));\n}\n";
+    return text;
+}
+
+template <typename Fn>
+double best(Fn fn) {
+    double best = 1e30;
+    for (unsigned i = 0; i < runs; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double>(
+                                  std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+}
+
+int main(int argc, const char **argv) {
+    cl::ParseCommandLineOptions(argc, argv, "Node type test benchmark\n");
+
+    std::string text = makeProgram();
+    if (!outputFilename.empty())
+        std::ofstream(outputFilename) << text;
+    SourceManager sourceManager;
+    const SourceFile &file = sourceManager.addFile(
+        "generated.al", llvm::MemoryBuffer::getMemBufferCopy(text, "generated.al"));
+    auto parse = [&](ASTContext &context) {
+        TheLexer lexer{sourceManager, file};
+        Parser parser(lexer, context);
+        return parser.parseProgram();
+    };
+
+    ASTContext context;
+    std::vector<FunctionDecl *> program = parse(context);
+    CollectStmts collect;
+    for (FunctionDecl *function : program) collect.visit(*function);
+    std::vector<std::unique_ptr<legacy::Stmt>> mirrors;
+    for (Stmt *stmt : collect.stmts) mirrors.push_back(legacy::mirror(stmt->getKind()));
+
+    unsigned sum = 0, legacySum = 0;
+    constexpr unsigned passes = 20;
+    double kindTime = best([&] {
+        for (unsigned pass = 0; pass < passes; ++pass)
+            for (Stmt *stmt : collect.stmts) sum += classify(*stmt);
+    });
+    double castTime = best([&] {
+        for (unsigned pass = 0; pass < passes; ++pass)
+            for (auto &stmt : mirrors) legacySum += legacy::classify(*stmt);
+    });
+    if (sum != legacySum) {
+        std::cerr << "the two classifications disagree\n";
+        return 1;
+    }
+
+    double semaTime = 1e30;
+    for (unsigned run = 0; run < runs; ++run) {
+        ASTContext semaContext;
+        std::vector<FunctionDecl *> fresh = parse(semaContext);
+        auto start = std::chrono::steady_clock::now();
+        SemanticAnalysis sema(fresh, sourceManager);
+        if (!sema.resolve()) {
+            std::cerr << "the generated program does not check\n";
+            return 1;
+        }
+        semaTime = std::min(semaTime, std::chrono::duration<double>(
+                                          std::chrono::steady_clock::now() - start).count());
+    }
+
+    double classified = static_cast<double>(collect.stmts.size()) * passes;
+    std::cout << "program: " << program.size() << " functions, " << collect.stmts.size()
+              << " statements and expressions\n"
+              << "kind switch:        " << kindTime / classified * 1e9 << " ns per node\n"
+              << "dynamic_cast chain: " << castTime / classified * 1e9 << " ns per node\n"
+              << "sema: " << semaTime * 1000 << " ms\n"
+              << "node sizes (bytes):";
+    const char *separator = " ";
+#define SIZE(CLASS) std::cout << separator << #CLASS " " << sizeof(CLASS), separator = ", ";
+    SIZE(Block) SIZE(ReturnStmt) SIZE(IfStmt) SIZE(WhileStmt) SIZE(ParamDecl)
+    SIZE(FunctionDecl) SIZE(VariableDecl) SIZE(PrintExpr) SIZE(NumberLiteral)
+    SIZE(StringLiteral) SIZE(BooleanLiteral) SIZE(DeclRefExpr) SIZE(CallExpr)
+    SIZE(BinaryExpr) SIZE(AssignmentExpr)
+#undef SIZE
+    std::cout << "\n";
+    return 0;
+}
@@ -0,0 +1,99 @@
+// Lexer throughput with each -lexer-simd implementation, on a corpus of
+// long comments, strings and indentation (where the scanners do the work)
+// and on dense short-token code (where forming tokens does).
+//
+//   ram-bench-scanner [-size-mb=N] [-runs=R]
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "lexer.h"
+#include "scanner.h"
+#include "sourcemanager.h"
+
+namespace cl = llvm::cl;
+
+static cl::opt<unsigned> sizeMB("size-mb", cl::desc("Size of each corpus in MB"), cl::init(64));
+static cl::opt<unsigned> runs("runs", cl::desc("Runs per measurement; the best is reported"),
+                              cl::init(3));
+
+namespace {
+std::string makeSparseCorpus(size_t size, std::mt19937 &rng) {
+    std::uniform_int_distribution<int> length(20, 200);
+    std::uniform_int_distribution<int> indent(0, 24);
+    std::string text;
+    while (text.size() < size) {
+        text.append(indent(rng), ' ');
+        text += "# " + std::string(length(rng), 'c') + "\n";
+        text.append(indent(rng), ' ');
+        text += "/* " + std::string(length(rng), 'b') + "\n" + std::string(length(rng), 'b') + " */\n";
+        text.append(indent(rng), ' ');
+        text += "print(\"" + std::string(length(rng), 's') + "\");\n";
+        text.append(indent(rng), ' ');
+        text += "var long_identifier_" + std::string(length(rng) / 8, 'i') + " = 1;\n";
+    }
+    return text;
+}
+
+std::string makeDenseCorpus(size_t size, std::mt19937 &rng) {
+    std::uniform_int_distribution<int> value(0, 999);
+    std::string text;
+    while (text.size() < size) {
+        int v = value(rng);
+        text += "var a" + std::to_string(v) + " = b + " + std::to_string(v) +
+                " * (c - d);\nif (a < b) { x = f(y, z); }\n";
+    }
+    return text;
+}
+
+// Best wall-clock time of `runs` calls to `fn`, in seconds.
+template <typename Fn>
+double best(Fn fn) {
+    double best = 1e30;
+    for (unsigned i = 0; i < runs; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double>(
+                                  std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+}
+
+int main(int argc, const char **argv) {
+    cl::ParseCommandLineOptions(argc, argv, "Lexer scanning benchmark\n");
+
+    std::mt19937 rng(42);
+    size_t size = static_cast<size_t>(sizeMB) << 20;
+    SourceManager sourceManager;
+    const SourceFile &sparse = sourceManager.addFile(
+        "sparse.al", llvm::MemoryBuffer::getMemBufferCopy(makeSparseCorpus(size, rng), "sparse.al"));
+    const SourceFile &dense = sourceManager.addFile(
+        "dense.al", llvm::MemoryBuffer::getMemBufferCopy(makeDenseCorpus(size, rng), "dense.al"));
+
+    for (const SourceFile *file : {&sparse, &dense}) {
+        std::cout << file->path << " (" << file->buffer.size() / (1 << 20) << " MB):\n";
+        for (scan::ISA isa : {scan::ISA::Scalar, scan::ISA::SSE2, scan::ISA::AVX2}) {
+            if (scan::selectISA(isa) != isa) {
+                std::cout << "  " << scan::isaName(isa) << ": not supported by this CPU\n";
+                continue;
+            }
+            size_t tokens = 0;
+            double time = best([&] {
+                TheLexer lexer{sourceManager, *file};
+                tokens = 0;
+                while (lexer.getNextToken().kind != TokenKind::eof)
+                    ++tokens;
+            });
+            std::cout << "  " << scan::isaName(isa) << ": " << file->buffer.size() / time / 1e9
+                      << " GB/s (" << tokens << " tokens)\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+// Symbol table benchmark. Generates a program of many functions with many
+// locals each, parses it once, and times sema on it, which for every local
+// looks its name up (to reject a redeclaration), declares it and then
+// looks it up again where it is used.
+//
+//   ram-bench-symbols [-functions=N] [-locals=L] [-runs=R] [-o=<file>]
+//
+// -o also writes the program out, so that `ram-compiler -frontend-stats
+// <file>` can time the same input at any commit.
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "astcontext.h"
+#include "lexer.h"
+#include "parser.h"
+#include "sema.h"
+#include "sourcemanager.h"
+
+namespace cl = llvm::cl;
+
+static cl::opt<unsigned> numFunctions("functions", cl::desc("Functions in the program"),
+                                      cl::init(20000));
+static cl::opt<unsigned> numLocals("locals", cl::desc("Locals in each function"), cl::init(40));
+static cl::opt<unsigned> runs("runs", cl::desc("Runs; the best is reported"), cl::init(5));
+static cl::opt<std::string> outputFilename("o", cl::desc("Also write the program to <file>"),
+                                           cl::value_desc("file"), cl::init(""));
+
+namespace {
+// Each local is initialized from the one before it, half of them in a
+// nested block, and each body ends with a call to an earlier function.
+std::string makeProgram() {
+    std::string text;
+    for (unsigned i = 0; i < numFunctions; ++i) {
+        text += "func f" + std::to_string(i) + "(a: int): int {\n    int v0 = a;\n";
+        for (unsigned l = 1; l < numLocals; ++l) {
+            std::string local = "v" + std::to_string(l);
+            std::string previous = "v" + std::to_string(l - 1);
+            if (l % 2)
+                text += "    if (" + previous + " < a) {\n        int " + local + "b = " +
+                        previous + " + a;\n        print(" + local + "b);\n    }\n";
+            text += "    int " + local + " = " + previous + " + a;\n";
+        }
+        text += "    return v" + std::to_string(numLocals - 1) + " + f" +
+                std::to_string(i / 2) + "(a);\n}\n\n";
+    }
+    text += "func main(): void {\n    print(f0(1));\n}\n";
+    return text;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+}
+
+int main(int argc, const char **argv) {
+    cl::ParseCommandLineOptions(argc, argv, "Symbol table benchmark\n");
+    numLocals = std::max(numLocals.getValue(), 1u);
+
+    std::string text = makeProgram();
+    if (!outputFilename.empty())
+        std::ofstream(outputFilename) << text;
+    SourceManager sourceManager;
+    const SourceFile &file = sourceManager.addFile(
+        "generated.al", llvm::MemoryBuffer::getMemBufferCopy(text, "generated.al"));
+    ASTContext context;
+    TheLexer lexer{sourceManager, file};
+    Parser parser(lexer, context);
+    std::vector<FunctionDecl *> program = parser.parseProgram();
+
+    double best = 1e30;
+    bool ok = true;
+    for (unsigned run = 0; run < runs; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        SemanticAnalysis sema(program, sourceManager);
+        ok = sema.resolve() && ok;
+        best = std::min(best, secondsSince(start));
+    }
+    if (!ok) {
+        std::cerr << "sema failed on the generated program\n";
+        return 1;
+    }
+
+    size_t locals = static_cast<size_t>(numFunctions) * (numLocals + numLocals / 2);
+    std::cout << "program: " << program.size() << " functions, " << locals << " locals, "
+              << text.size() / (1 << 20) << " MB\n"
+              << "sema: " << best * 1000 << " ms (" << best / locals * 1e9
+              << " ns per local)\n";
+    return 0;
+}
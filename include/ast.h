@@ -7,11 +7,17 @@
 #include <memory>
 #include <utility>
 #include <optional>
+#include <charconv>
+#include <cstdint>
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Casting.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "utils.h"
 #include "token.h"
 
-enum class Type { INT, FLOAT, STRING, VOID };
+enum class Type : uint8_t { INT, FLOAT, STRING, VOID, BOOL };
 
 inline std::string typeToString(Type t) {
     switch (t) {
@@ -19,106 +25,106 @@ inline std::string typeToString(Type t) {
         case Type::FLOAT: return "float";
         case Type::STRING: return "string";
         case Type::VOID: return "void";
+        case Type::BOOL: return "bool";
     }
     return "unknown";
 }
 
-class ASTVisitor {
-public:
-    virtual ~ASTVisitor() = default;
-
-    virtual void visit(class Stmt          &node) = 0;
-    virtual void visit(class Block         &node) = 0;
-    virtual void visit(class PrintExpr     &node) = 0;
-    virtual void visit(class ReturnStmt    &node) =0;
-    virtual void visit(class IfStmt        &node) = 0;
-    virtual void visit(class WhileStmt     &node) = 0;
-
-    virtual void visit(class Decl          &node) = 0;
-    virtual void visit(class ParamDecl     &node) = 0;
-    virtual void visit(class VariableDecl  &node) = 0;
-    virtual void visit(class FunctionDecl  &node) = 0;
-
-    virtual void visit(class Expr          &node) = 0;
-    virtual void visit(class NumberLiteral &node) = 0;
-    virtual void visit(class StringLiteral &node) = 0;
-    virtual void visit(class BooleanLiteral &node) = 0;
-    virtual void visit(class DeclRefExpr   &node) = 0;
-    virtual void visit(class CallExpr      &node) = 0;
-    virtual void visit(class BinaryExpr    &node) = 0;
-    virtual void visit(class AssignmentExpr &node) = 0;
-
-    void setLevel(size_t l) { currentLevel = l; }
-    size_t getLevel() const { return currentLevel; }
-
-protected:
-    size_t currentLevel = 0;
+// One tag per concrete node class, for isa/dyn_cast/cast and for switching
+// over nodes. The subclasses of each abstract class form one contiguous
+// range, which is what their classof checks.
+enum class NodeKind : uint8_t {
+    Block,
+    // Stmt
+    ReturnStmt,
+    IfStmt,
+    WhileStmt,
+    // Stmt > Decl
+    ParamDecl,
+    FunctionDecl,
+    VariableDecl,
+    // Stmt > Expr
+    PrintExpr,
+    NumberLiteral,
+    StringLiteral,
+    BooleanLiteral,
+    DeclRefExpr,
+    CallExpr,
+    BinaryExpr,
+    AssignmentExpr,
 };
 
-class ASTNode : public Dumpable {
+// Nodes have no virtual functions: passes dispatch on the kind (see
+// ASTVisitor below), and the ASTContext never runs destructors.
+class ASTNode {
+    NodeKind kind;
+
 public:
     SourceLocation location;
-    explicit ASTNode(SourceLocation loc) : location(std::move(loc)) {}
-    virtual ~ASTNode() = default;
-    virtual void accept(ASTVisitor &visitor) = 0;
-    void dump(size_t level = 0) override;
+    ASTNode(NodeKind kind, SourceLocation loc) : kind(kind), location(loc) {}
+    NodeKind getKind() const { return kind; }
+    void dump(size_t level = 0);
 };
 
-class DumpVisitor;
-
-
-class Stmt : public virtual ASTNode {
+class Stmt : public ASTNode {
 public:
     using ASTNode::ASTNode;
-    void accept(ASTVisitor &visitor) override =0;
+    static bool classof(const ASTNode *node) { return node->getKind() >= NodeKind::ReturnStmt; }
 };
 
+// The child lists of Block, PrintExpr and CallExpr are arena arrays that a
+// pass rewriting the tree (constant folding) may replace elements of, in
+// place, through the set* functions; the lists keep their length.
 class Block : public ASTNode {
 public:
-    std::vector<std::unique_ptr<Stmt>> statements;
-    Block(SourceLocation loc,
-          std::vector<std::unique_ptr<Stmt>> stmts)
-        : ASTNode(std::move(loc)), statements(std::move(stmts)) {}
-    void accept(ASTVisitor &visitor) override { visitor.visit(*this); }
+    llvm::MutableArrayRef<Stmt *> statements;
+    Block(SourceLocation loc, llvm::MutableArrayRef<Stmt *> stmts)
+        : ASTNode(NodeKind::Block, loc), statements(stmts) {}
+    void setStatement(size_t index, Stmt *stmt) { statements[index] = stmt; }
+    static bool classof(const ASTNode *node) { return node->getKind() == NodeKind::Block; }
 };
 
 /*-------------------- Declarations --------------------*/
 
-class Decl : public virtual ASTNode {
+// Declarations are statements, so that a VariableDecl can sit in a Block
+// with single inheritance only.
+class Decl : public Stmt {
 public:
-    std::string identifier;
+    Symbol identifier;
     std::optional<Type> resolvedType;  // Populated during semantic analysis
     
-    Decl(SourceLocation loc, std::string id)
-        : ASTNode(std::move(loc)), identifier(std::move(id)) {}
-    void accept(ASTVisitor &visitor) override  =0;
+    Decl(NodeKind kind, SourceLocation loc, Symbol id)
+        : Stmt(kind, loc), identifier(id) {}
+    static bool classof(const ASTNode *node) {
+        return node->getKind() >= NodeKind::ParamDecl && node->getKind() <= NodeKind::VariableDecl;
+    }
 };
 
 class ParamDecl : public Decl {
 public:
-    std::string type;  
+    llvm::StringRef type;  
     
-    ParamDecl(SourceLocation loc, std::string id, std::string tp)
-        : ASTNode(loc), Decl(loc, id), type(std::move(tp)) {}
-    void accept(ASTVisitor &visitor) override { visitor.visit(*this); };
+    ParamDecl(SourceLocation loc, Symbol id, llvm::StringRef tp)
+        : Decl(NodeKind::ParamDecl, loc, id), type(tp) {}
+    static bool classof(const ASTNode *node) { return node->getKind() == NodeKind::ParamDecl; }
 };
 
 class FunctionDecl : public Decl {
 public:
-    std::string funtype;  // String return type from parser
-    std::vector<std::unique_ptr<ParamDecl>> params;
-    std::unique_ptr<Block> body;
+    llvm::StringRef funtype;  // String return type from parser
+    llvm::ArrayRef<ParamDecl *> params;
+    Block *body;
     
     FunctionDecl(SourceLocation loc,
-                 std::string name,
-                 std::string ft,
-                 std::vector<std::unique_ptr<ParamDecl>> ps,
-                 std::unique_ptr<Block> b)
-        : ASTNode(loc), Decl(loc, name),
-          funtype(std::move(ft)),
-          params(std::move(ps)),
-          body(std::move(b)) {}
-    void accept(ASTVisitor &visitor) override { visitor.visit(*this); }
+                 Symbol name,
+                 llvm::StringRef ft,
+                 llvm::ArrayRef<ParamDecl *> ps,
+                 Block *b)
+        : Decl(NodeKind::FunctionDecl, loc, name),
+          funtype(ft),
+          params(ps),
+          body(b) {}
+    static bool classof(const ASTNode *node) { return node->getKind() == NodeKind::FunctionDecl; }
 };
 
 /*-------------------- Expressions --------------------*/
@@ -127,38 +133,57 @@ class Expr : public Stmt {
 public:
     std::optional<Type> resolvedType;  // Populated during semantic analysis
     using Stmt::Stmt;
+    static bool classof(const ASTNode *node) { return node->getKind() >= NodeKind::PrintExpr; }
 };
 
 class PrintExpr : public Expr {
 public:
-    std::vector<std::unique_ptr<Expr>> args;
+    llvm::MutableArrayRef<Expr *> args;
     
-    PrintExpr(SourceLocation loc,
-              std::vector<std::unique_ptr<Expr>> a)
-        : ASTNode(loc), Expr(loc), args(std::move(a)) {}
-    void accept(ASTVisitor &visitor) override { visitor.visit(*this); }
+    PrintExpr(SourceLocation loc, llvm::MutableArrayRef<Expr *> a)
+        : Expr(NodeKind::PrintExpr, loc), args(a) {}
+    void setArgument(size_t index, Expr *arg) { args[index] = arg; }
+    static bool classof(const ASTNode *node) { return node->getKind() == NodeKind::PrintExpr; }
 };
 
 class NumberLiteral : public Expr {
 public:
-    std::string value;
+    // Decoded by the lexer; resolvedType says which member is set.
+    union {
+        int64_t intValue;
+        double floatValue;
+    };
     
-    NumberLiteral(SourceLocation loc, std::string v, Type t)
-        : ASTNode(loc), Expr(loc), value(std::move(v)) {
-        resolvedType = t; 
+    NumberLiteral(SourceLocation loc, int64_t v)
+        : Expr(NodeKind::NumberLiteral, loc), intValue(v) {
+        resolvedType = Type::INT; 
     }
-    void accept(ASTVisitor &visitor) override { visitor.visit(*this); }
+    NumberLiteral(SourceLocation loc, double v)
+        : Expr(NodeKind::NumberLiteral, loc), floatValue(v) {
+        resolvedType = Type::FLOAT; 
+    }
+
+    // Shortest spelling that reads back as the same value.
+    std::string getValueAsString() const {
+        char buf[32];
+        if (resolvedType != Type::FLOAT)
+            return std::string(buf, std::to_chars(buf, buf + sizeof(buf), intValue).ptr);
+        std::string str(buf, std::to_chars(buf, buf + sizeof(buf), floatValue).ptr);
+        if (str.find_first_of(".en") == std::string::npos) str += ".0";
+        return str;
+    }
+    static bool classof(const ASTNode *node) { return node->getKind() == NodeKind::NumberLiteral; }
 };
 
 class StringLiteral : public Expr {
 public:
-    std::string value;
+    llvm::StringRef value;
     
-    StringLiteral(SourceLocation loc, std::string v)
-        : ASTNode(loc), Expr(loc), value(std::move(v)) {
+    StringLiteral(SourceLocation loc, llvm::StringRef v)
+        : Expr(NodeKind::StringLiteral, loc), value(v) {
         resolvedType = Type::STRING;  
     }
-    void accept(ASTVisitor &visitor) override { visitor.visit(*this); }
+    static bool classof(const ASTNode *node) { return node->getKind() == NodeKind::StringLiteral; }
 };
 
 class BooleanLiteral : public Expr {
@@ -166,127 +191,190 @@ public:
     bool value;
     
     BooleanLiteral(SourceLocation loc, bool v)
-        : ASTNode(loc), Expr(loc), value(v) {
-        resolvedType = Type::INT;  // Treat booleans as integers (0/1)
+        : Expr(NodeKind::BooleanLiteral, loc), value(v) {
+        resolvedType = Type::BOOL;
     }
-    void accept(ASTVisitor &visitor) override { visitor.visit(*this); }
+    static bool classof(const ASTNode *node) { return node->getKind() == NodeKind::BooleanLiteral; }
 };
 
 class DeclRefExpr : public Expr {
 public:
-    std::string identifier;
+    Symbol identifier;
     Decl *resolvedDecl = nullptr;  // Set during semantic analysis
     
-    DeclRefExpr(SourceLocation loc, std::string id)
-        : ASTNode(loc), Expr(loc), identifier(std::move(id)) {}
-    void accept(ASTVisitor &visitor) override { visitor.visit(*this); }
+    DeclRefExpr(SourceLocation loc, Symbol id)
+        : Expr(NodeKind::DeclRefExpr, loc), identifier(id) {}
+    static bool classof(const ASTNode *node) { return node->getKind() == NodeKind::DeclRefExpr; }
 };
 
-class VariableDecl : public Stmt, public Decl {
+class VariableDecl : public Decl {
 public:
-    std::string type;
-    std::unique_ptr<Expr> initializer; 
+    llvm::StringRef type;
+    Expr *initializer; 
 
-    VariableDecl(SourceLocation loc,std::string id, std::string tp, std::unique_ptr<Expr> init = nullptr)
-        : ASTNode(loc), Stmt(loc), Decl(loc, id), type(std::move(tp)), initializer(std::move(init)) {}
+    VariableDecl(SourceLocation loc, Symbol id, llvm::StringRef tp, Expr *init = nullptr)
+        : Decl(NodeKind::VariableDecl, loc, id), type(tp), initializer(init) {}
 
-    void accept(ASTVisitor &visitor) override {visitor.visit(*this);}
+    static bool classof(const ASTNode *node) { return node->getKind() == NodeKind::VariableDecl; }
 };
 class ReturnStmt : public Stmt{
     public:
-      std::unique_ptr<Expr> expr=nullptr;
-      ReturnStmt(SourceLocation location, std::unique_ptr<Expr> expr)
-      : ASTNode(location), Stmt(location),
-        expr(std::move(expr)) {}
-    void accept(ASTVisitor &visitor) override { visitor.visit(*this); }
+      Expr *expr=nullptr;
+      ReturnStmt(SourceLocation location, Expr *expr)
+      : Stmt(NodeKind::ReturnStmt, location),
+        expr(expr) {}
+    static bool classof(const ASTNode *node) { return node->getKind() == NodeKind::ReturnStmt; }
 };
 
 class IfStmt : public Stmt {
 public:
-    std::unique_ptr<Expr> condition;
-    std::unique_ptr<Block> thenBlock;
-    std::unique_ptr<Block> elseBlock;  // Optional
+    Expr *condition;
+    Block *thenBlock;
+    Block *elseBlock;  // Optional
 
     IfStmt(SourceLocation loc,
-           std::unique_ptr<Expr> cond,
-           std::unique_ptr<Block> thenB,
-           std::unique_ptr<Block> elseB = nullptr)
-        : ASTNode(loc), Stmt(loc),
-          condition(std::move(cond)),
-          thenBlock(std::move(thenB)),
-          elseBlock(std::move(elseB)) {}
-
-    void accept(ASTVisitor &visitor) override { visitor.visit(*this); }
+           Expr *cond,
+           Block *thenB,
+           Block *elseB = nullptr)
+        : Stmt(NodeKind::IfStmt, loc),
+          condition(cond),
+          thenBlock(thenB),
+          elseBlock(elseB) {}
+
+    static bool classof(const ASTNode *node) { return node->getKind() == NodeKind::IfStmt; }
 };
 
 class WhileStmt : public Stmt {
 public:
-    std::unique_ptr<Expr> condition;
-    std::unique_ptr<Block> body;
+    Expr *condition;
+    Block *body;
 
     WhileStmt(SourceLocation loc,
-              std::unique_ptr<Expr> cond,
-              std::unique_ptr<Block> b)
-        : ASTNode(loc), Stmt(loc),
-          condition(std::move(cond)),
-          body(std::move(b)) {}
+              Expr *cond,
+              Block *b)
+        : Stmt(NodeKind::WhileStmt, loc),
+          condition(cond),
+          body(b) {}
 
-    void accept(ASTVisitor &visitor) override { visitor.visit(*this); }
+    static bool classof(const ASTNode *node) { return node->getKind() == NodeKind::WhileStmt; }
 };
 
 class CallExpr : public Expr {
 public:
-    std::string identifier;
-    std::vector<std::unique_ptr<Expr>> arguments;
+    Symbol identifier;
+    llvm::MutableArrayRef<Expr *> arguments;
     FunctionDecl *resolvedCallee = nullptr;  // Set during semantic analysis
     
     CallExpr(SourceLocation loc,
-             std::string id,
-             std::vector<std::unique_ptr<Expr>> args)
-        : ASTNode(loc), Expr(loc),
-          identifier(std::move(id)),
-          arguments(std::move(args)) {}
-    void accept(ASTVisitor &visitor) override { visitor.visit(*this); }
+             Symbol id,
+             llvm::MutableArrayRef<Expr *> args)
+        : Expr(NodeKind::CallExpr, loc),
+          identifier(id),
+          arguments(args) {}
+    void setArgument(size_t index, Expr *arg) { arguments[index] = arg; }
+    static bool classof(const ASTNode *node) { return node->getKind() == NodeKind::CallExpr; }
 };
 
 class BinaryExpr : public Expr {
 public:
-    std::unique_ptr<Expr> left;
+    Expr *left;
     TokenKind op;
-    std::unique_ptr<Expr> right;
+    Expr *right;
 
     BinaryExpr(SourceLocation loc,
-               std::unique_ptr<Expr> lhs,
+               Expr *lhs,
                TokenKind operation,
-               std::unique_ptr<Expr> rhs)
-        : ASTNode(loc), Expr(loc),
-          left(std::move(lhs)),
+               Expr *rhs)
+        : Expr(NodeKind::BinaryExpr, loc),
+          left(lhs),
           op(operation),
-          right(std::move(rhs)) {}
+          right(rhs) {}
 
-    void accept(ASTVisitor &visitor) override { visitor.visit(*this); }
+    static bool classof(const ASTNode *node) { return node->getKind() == NodeKind::BinaryExpr; }
 };
 
 class AssignmentExpr : public Expr {
 public:
-    std::string target;  // Variable name being assigned to
-    std::unique_ptr<Expr> value;  // RHS expression
+    Symbol target;  // Variable name being assigned to
+    Expr *value;  // RHS expression
     Decl *resolvedTarget = nullptr;  // Set during semantic analysis
 
     AssignmentExpr(SourceLocation loc,
-                   std::string tgt,
-                   std::unique_ptr<Expr> val)
-        : ASTNode(loc), Expr(loc),
-          target(std::move(tgt)),
-          value(std::move(val)) {}
+                   Symbol tgt,
+                   Expr *val)
+        : Expr(NodeKind::AssignmentExpr, loc),
+          target(tgt),
+          value(val) {}
 
-    void accept(ASTVisitor &visitor) override { visitor.visit(*this); }
+    static bool classof(const ASTNode *node) { return node->getKind() == NodeKind::AssignmentExpr; }
 };
 
 
 
-class DumpVisitor : public ASTVisitor {
+// Walks the AST by switching on the node kind, so every call lands in the
+// derived class's method for the exact node class and can be inlined. A
+// visitor defines the visitX methods it cares about; the others fall back
+// to the one for the base class (visitParamDecl -> visitDecl -> visitStmt),
+// and finally to visitNode. All of them return RetTy, e.g. the llvm::Value
+// an expression computes.
+template <typename Derived, typename RetTy = void>
+class ASTVisitor {
+    Derived &derived() { return *static_cast<Derived *>(this); }
+
 public:
+    RetTy visit(ASTNode &node) {
+        switch (node.getKind()) {
+#define DISPATCH(CLASS) \
+        case NodeKind::CLASS: return derived().visit##CLASS(llvm::cast<CLASS>(node));
+        DISPATCH(Block)
+        DISPATCH(ReturnStmt)
+        DISPATCH(IfStmt)
+        DISPATCH(WhileStmt)
+        DISPATCH(ParamDecl)
+        DISPATCH(FunctionDecl)
+        DISPATCH(VariableDecl)
+        DISPATCH(PrintExpr)
+        DISPATCH(NumberLiteral)
+        DISPATCH(StringLiteral)
+        DISPATCH(BooleanLiteral)
+        DISPATCH(DeclRefExpr)
+        DISPATCH(CallExpr)
+        DISPATCH(BinaryExpr)
+        DISPATCH(AssignmentExpr)
+#undef DISPATCH
+        }
+        llvm_unreachable("unknown node kind");
+    }
+
+    RetTy visitNode(ASTNode &) { return RetTy(); }
+    RetTy visitBlock(Block &node) { return derived().visitNode(node); }
+    RetTy visitStmt(Stmt &node) { return derived().visitNode(node); }
+    RetTy visitReturnStmt(ReturnStmt &node) { return derived().visitStmt(node); }
+    RetTy visitIfStmt(IfStmt &node) { return derived().visitStmt(node); }
+    RetTy visitWhileStmt(WhileStmt &node) { return derived().visitStmt(node); }
+
+    RetTy visitDecl(Decl &node) { return derived().visitStmt(node); }
+    RetTy visitParamDecl(ParamDecl &node) { return derived().visitDecl(node); }
+    RetTy visitFunctionDecl(FunctionDecl &node) { return derived().visitDecl(node); }
+    RetTy visitVariableDecl(VariableDecl &node) { return derived().visitDecl(node); }
+
+    RetTy visitExpr(Expr &node) { return derived().visitStmt(node); }
+    RetTy visitPrintExpr(PrintExpr &node) { return derived().visitExpr(node); }
+    RetTy visitNumberLiteral(NumberLiteral &node) { return derived().visitExpr(node); }
+    RetTy visitStringLiteral(StringLiteral &node) { return derived().visitExpr(node); }
+    RetTy visitBooleanLiteral(BooleanLiteral &node) { return derived().visitExpr(node); }
+    RetTy visitDeclRefExpr(DeclRefExpr &node) { return derived().visitExpr(node); }
+    RetTy visitCallExpr(CallExpr &node) { return derived().visitExpr(node); }
+    RetTy visitBinaryExpr(BinaryExpr &node) { return derived().visitExpr(node); }
+    RetTy visitAssignmentExpr(AssignmentExpr &node) { return derived().visitExpr(node); }
+};
+
+class DumpVisitor : public ASTVisitor<DumpVisitor> {
+    size_t currentLevel = 0;
+
+public:
+    explicit DumpVisitor(size_t level = 0) : currentLevel(level) {}
+
     void dumpHeader(const std::string &msg) const {
         indent(currentLevel);
         std::cerr << msg << "\n";
@@ -296,161 +384,148 @@ public:
     }
 
     /* Statements */
-    void visit(Stmt &node) override { dumpHeader("Stmt"); }
-    void visit(Block &node) override {
+    void visitBlock(Block &node) {
         dumpHeader("Block:");
         size_t oldLevel = currentLevel;
         currentLevel++;
         for (auto &s : node.statements) {
-            s->accept(*this);
+            visit(*s);
         }
         currentLevel = oldLevel;
     }
-    void visit(PrintExpr &node) override {
+    void visitPrintExpr(PrintExpr &node) {
         std::string typeInfo = node.resolvedType ? 
             " : " + typeToString(*node.resolvedType) : "";
         dumpHeader("PrintExpr" + typeInfo + ":");
         size_t oldLevel = currentLevel;
         currentLevel++;
-        for (auto &a : node.args) a->accept(*this);
+        for (auto &a : node.args) visit(*a);
         currentLevel = oldLevel;
     }
 
-    void visit(Decl &node) override {
+    void visitParamDecl(ParamDecl &node) {
         std::string typeInfo = node.resolvedType ? 
-            " : " + typeToString(*node.resolvedType) : "";
-        dumpHeader("Decl: " + node.identifier + typeInfo);
-    }
-    void visit(ParamDecl &node) override {
-        std::string typeInfo = node.resolvedType ? 
-            " : " + typeToString(*node.resolvedType) : " : " + node.type;
-        dumpHeader("Parameter Declaration: " + node.identifier + typeInfo);
+            " : " + typeToString(*node.resolvedType) : " : " + node.type.str();
+        dumpHeader("Parameter Declaration: " + node.identifier.str() + typeInfo);
     }
-    void visit(FunctionDecl &node) override {
+    void visitFunctionDecl(FunctionDecl &node) {
         std::string typeInfo = node.resolvedType ? 
-            " : " + typeToString(*node.resolvedType) : " : " + node.funtype;
-        dumpHeader("FunctionDecl: " + node.identifier + typeInfo);
+            " : " + typeToString(*node.resolvedType) : " : " + node.funtype.str();
+        dumpHeader("FunctionDecl: " + node.identifier.str() + typeInfo);
         size_t oldLevel = currentLevel;
         currentLevel++;
-        for (auto &p : node.params) p->accept(*this);
-        if (node.body) node.body->accept(*this);
+        for (auto &p : node.params) visitParamDecl(*p);
+        if (node.body) visitBlock(*node.body);
         currentLevel = oldLevel;
     }
 
-    void visit(ReturnStmt & node) override{
+    void visitReturnStmt(ReturnStmt & node) {
     dumpHeader("ReturnStmt: "); 
     size_t oldLevel = currentLevel;
         currentLevel++;
     if (node.expr) {
-        node.expr->accept(*this);
+        visit(*node.expr);
     }
     currentLevel = oldLevel;
     }
 
-    void visit(IfStmt &node) override {
+    void visitIfStmt(IfStmt &node) {
         dumpHeader("IfStmt:");
         size_t oldLevel = currentLevel;
         currentLevel++;
         dumpHeader("Condition:");
         currentLevel++;
-        node.condition->accept(*this);
+        visit(*node.condition);
         currentLevel--;
         dumpHeader("Then:");
-        node.thenBlock->accept(*this);
+        visitBlock(*node.thenBlock);
         if (node.elseBlock) {
             dumpHeader("Else:");
-            node.elseBlock->accept(*this);
+            visitBlock(*node.elseBlock);
         }
         currentLevel = oldLevel;
     }
 
-    void visit(WhileStmt &node) override {
+    void visitWhileStmt(WhileStmt &node) {
         dumpHeader("WhileStmt:");
         size_t oldLevel = currentLevel;
         currentLevel++;
         dumpHeader("Condition:");
         currentLevel++;
-        node.condition->accept(*this);
+        visit(*node.condition);
         currentLevel--;
         dumpHeader("Body:");
-        node.body->accept(*this);
+        visitBlock(*node.body);
         currentLevel = oldLevel;
     }
     
     /* Expressions */
-    void visit(Expr &node) override { 
-        std::string typeInfo = node.resolvedType ? 
-            " : " + typeToString(*node.resolvedType) : "";
-        dumpHeader("Expr" + typeInfo); 
-    }
-    void visit(NumberLiteral &node) override { 
+    void visitNumberLiteral(NumberLiteral &node) { 
         std::string typeInfo = node.resolvedType ? 
             " : " + typeToString(*node.resolvedType) : "";
-        dumpHeader("NumberLiteral " + node.value + typeInfo); 
+        dumpHeader("NumberLiteral " + node.getValueAsString() + typeInfo); 
     }
-    void visit(StringLiteral &node) override { 
+    void visitStringLiteral(StringLiteral &node) { 
         std::string typeInfo = node.resolvedType ? 
             " : " + typeToString(*node.resolvedType) : "";
-        dumpHeader("StringLiteral: " + node.value + typeInfo); 
+        dumpHeader("StringLiteral: " + node.value.str() + typeInfo); 
     }
-    void visit(BooleanLiteral &node) override { 
+    void visitBooleanLiteral(BooleanLiteral &node) { 
         std::string typeInfo = node.resolvedType ? 
             " : " + typeToString(*node.resolvedType) : "";
         dumpHeader("BooleanLiteral: " + std::string(node.value ? "true" : "false") + typeInfo); 
     }
-    void visit(DeclRefExpr &node) override { 
+    void visitDeclRefExpr(DeclRefExpr &node) { 
         std::string typeInfo = node.resolvedType ? 
             " : " + typeToString(*node.resolvedType) : "";
-        dumpHeader("DeclRefExpr: " + node.identifier + typeInfo); 
+        dumpHeader("DeclRefExpr: " + node.identifier.str() + typeInfo); 
     }
-    void visit(CallExpr &node) override {
+    void visitCallExpr(CallExpr &node) {
         std::string typeInfo = node.resolvedType ? 
             " : " + typeToString(*node.resolvedType) : "";
         dumpHeader("CallExpr" + typeInfo + ":");
         size_t oldLevel = currentLevel;
         currentLevel++;
-        dumpHeader("Identifier: " + node.identifier);
-        for (auto &a : node.arguments) a->accept(*this);
+        dumpHeader("Identifier: " + node.identifier.str());
+        for (auto &a : node.arguments) visit(*a);
         currentLevel = oldLevel;
     }
-    void visit(BinaryExpr &node) override {
+    void visitBinaryExpr(BinaryExpr &node) {
         std::string typeInfo = node.resolvedType ? 
             " : " + typeToString(*node.resolvedType) : "";
         dumpHeader("BinaryExpr" + typeInfo + ": " + Token::kindToString(node.op));
         size_t oldLevel = currentLevel;
         currentLevel++;
-        node.left->accept(*this);
-        node.right->accept(*this);
+        visit(*node.left);
+        visit(*node.right);
         currentLevel = oldLevel;
     }
-    void visit(VariableDecl &node) override {
+    void visitVariableDecl(VariableDecl &node) {
         std::string typeInfo = node.resolvedType ? 
-            " : " + typeToString(*node.resolvedType) : " : " + node.type;
+            " : " + typeToString(*node.resolvedType) : " : " + node.type.str();
         std::string initInfo = node.initializer ? " (with initializer)" : "";
-        dumpHeader("VariableDecl: " + node.identifier + typeInfo + initInfo);
+        dumpHeader("VariableDecl: " + node.identifier.str() + typeInfo + initInfo);
         if (node.initializer) {
             size_t oldLevel = currentLevel;
             currentLevel++;
-            node.initializer->accept(*this);
+            visit(*node.initializer);
             currentLevel = oldLevel;
         }
     }
-    void visit(AssignmentExpr &node) override {
+    void visitAssignmentExpr(AssignmentExpr &node) {
         std::string typeInfo = node.resolvedType ? 
             " : " + typeToString(*node.resolvedType) : "";
-        dumpHeader("AssignmentExpr" + typeInfo + ": " + node.target);
+        dumpHeader("AssignmentExpr" + typeInfo + ": " + node.target.str());
         size_t oldLevel = currentLevel;
         currentLevel++;
-        node.value->accept(*this);
+        visit(*node.value);
         currentLevel = oldLevel;
     }
 };
 
 // Implement ASTNode::dump
 inline void ASTNode::dump(size_t level) {
-    DumpVisitor visitor;
-    visitor.setLevel(level);
-    this->accept(visitor);
+    DumpVisitor(level).visit(*this);
 }
 
-#endif // AST_H
\ No newline at end of file
+#endif // AST_H
@@ -0,0 +1,58 @@
+#ifndef ASTCACHE_H
+#define ASTCACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "ast.h"
+#include "astcontext.h"
+#include "utils.h"
+
+// The checked AST of a source file, saved next to it, so that compiling an
+// unchanged file again skips lexing, parsing and sema.
+//
+// The file holds the nodes as an array of fixed-size records in post-order,
+// children before their parents, which refer to them by index; the same
+// goes for the declarations and callees sema bound names to. Loading maps
+// the file and makes one pass over the array, allocating each node in the
+// ASTContext from its record, and a second one to set the bindings, which
+// may point forward. Identifiers are stored by spelling and interned again;
+// locations are stored as offsets into the source.
+//
+// A cache is used only if it was written by this build of the compiler
+// (the build ID hashes its sources and build configuration) and this
+// version of the format, from a file with the same size and content hash,
+// in the same mode.
+class ASTCache {
+public:
+    enum class Status { NotLoaded, Hit, Missing, Stale, Invalid };
+
+    // Bump whenever the AST, the parser or sema changes what they produce
+    // for the same source.
+    static constexpr uint32_t formatVersion = 3;
+
+    // `mode` says how the AST was produced; caches from another mode miss.
+    ASTCache(std::string path, const SourceFile &source, uint32_t mode);
+
+    // Rebuilds the program in `context` if the cache matches the source.
+    bool load(ASTContext &context, std::vector<FunctionDecl *> &program);
+    bool store(llvm::ArrayRef<FunctionDecl *> program);
+
+    Status getStatus() const { return status; }
+    static const char *getStatusName(Status status);
+    size_t getNumNodes() const { return numNodes; }
+    size_t getFileSize() const { return fileSize; }
+
+private:
+    std::string path;
+    const SourceFile &source;
+    uint32_t mode;
+    uint64_t contentHash;
+    Status status = Status::NotLoaded;
+    size_t numNodes = 0;
+    size_t fileSize = 0;
+};
+
+#endif
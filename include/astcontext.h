@@ -0,0 +1,89 @@
+#ifndef ASTCONTEXT_H
+#define ASTCONTEXT_H
+
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
+
+// Owns the nodes of an AST. Nodes, their child arrays and their strings are
+// bump-allocated from one arena and released together with the context, so
+// building a tree costs a pointer bump per node and tearing it down costs
+// one free per slab. Nodes are never destroyed one by one: they may hold
+// only plain pointers, (Mutable)ArrayRefs and StringRefs, into this arena
+// or to things that outlive it.
+class ASTContext {
+    llvm::BumpPtrAllocator allocator;
+    size_t numNodes = 0;
+    std::vector<std::unique_ptr<ASTContext>> subContexts;
+
+public:
+    ASTContext() = default;
+    ASTContext(const ASTContext &) = delete;
+    ASTContext &operator=(const ASTContext &) = delete;
+
+    template <typename T, typename... Args>
+    T *create(Args &&...args) {
+        ++numNodes;
+        return new (allocator.Allocate<T>()) T(std::forward<Args>(args)...);
+    }
+
+    // Copies a child list built up in a temporary into the arena.
+    template <typename T>
+    llvm::MutableArrayRef<T> copyArray(llvm::ArrayRef<T> elements) {
+        static_assert(std::is_trivially_copyable<T>::value, "arena arrays are never destroyed");
+        if (elements.empty()) return {};
+        T *copy = allocator.Allocate<T>(elements.size());
+        std::uninitialized_copy(elements.begin(), elements.end(), copy);
+        return {copy, elements.size()};
+    }
+
+    llvm::StringRef copyString(llvm::StringRef str) {
+        if (str.empty()) return {};
+        char *copy = allocator.Allocate<char>(str.size());
+        std::memcpy(copy, str.data(), str.size());
+        return {copy, str.size()};
+    }
+
+    // A context for one thread to build part of the tree in, released
+    // together with this one. Create them all before the threads start;
+    // contexts are not thread-safe.
+    ASTContext &createSubContext() {
+        subContexts.push_back(std::make_unique<ASTContext>());
+        return *subContexts.back();
+    }
+
+    // Releases every node, keeping the first slab for the next tree, so a
+    // context that holds one function at a time stays the same size.
+    // Sub-contexts go too.
+    void reset() {
+        allocator.Reset();
+        numNodes = 0;
+        subContexts.clear();
+    }
+
+    // Totals over this context and its sub-contexts.
+    size_t getNumNodes() const {
+        size_t total = numNodes;
+        for (const auto &sub : subContexts) total += sub->getNumNodes();
+        return total;
+    }
+    // Bytes handed out, and bytes reserved from the system for them.
+    size_t getBytesAllocated() const {
+        size_t total = allocator.getBytesAllocated();
+        for (const auto &sub : subContexts) total += sub->getBytesAllocated();
+        return total;
+    }
+    size_t getTotalMemory() const {
+        size_t total = allocator.getTotalMemory();
+        for (const auto &sub : subContexts) total += sub->getTotalMemory();
+        return total;
+    }
+};
+
+#endif
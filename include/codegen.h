@@ -8,8 +8,13 @@
 #include "llvm/IR/Value.h"
 #include "llvm/IR/PassManager.h" 
 #include "llvm/Passes/PassBuilder.h" 
+#include "llvm/Target/TargetMachine.h"
 #include "llvm/Transforms/InstCombine/InstCombine.h" 
 #include "llvm/Analysis/InstructionSimplify.h" 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/ValueHandle.h"
 #include <map>
 #include <memory>
 #include <string>
@@ -17,27 +22,47 @@
 
 #include "ast.h"
 
-class Codegen : public ASTVisitor{
+class Codegen : public ASTVisitor<Codegen, llvm::Value *> {
     private:
     std::unique_ptr<llvm::LLVMContext> TheContext;
     std::unique_ptr<llvm::Module> TheModule;
     std::unique_ptr<llvm::IRBuilder<>> Builder;
-    std::map<std::string, llvm::Value *> NamedValues; 
-    llvm::Value* lastValue = nullptr;
+    // Locals are built straight into SSA form as they are lowered (Braun
+    // et al., "Simple and Efficient Construction of Static Single
+    // Assignment Form"): each block records the value last assigned to
+    // each variable there, and a read in a block that did not assign looks
+    // through its predecessors, placing a phi where they meet. A block is
+    // sealed once all its predecessors branch to it; reads in a block not
+    // yet sealed get a phi whose operands are filled in at sealing. Phis
+    // that turn out to merge one value are replaced by it. Variables are
+    // the VariableDecls and ParamDecls sema bound names to.
+    //
+    // Definitions are held by value handles, which follow a trivial phi
+    // to the value that replaces it.
+    llvm::DenseMap<llvm::BasicBlock *, llvm::DenseMap<const Decl *, llvm::WeakTrackingVH>> currentDef;
+    llvm::DenseMap<llvm::BasicBlock *, llvm::SmallVector<std::pair<const Decl *, llvm::PHINode *>, 4>>
+        incompletePhis;
+    llvm::SmallPtrSet<llvm::BasicBlock *, 16> sealedBlocks;
+    // The llvm::Function of each function, by the declaration sema bound
+    // calls to.
+    llvm::DenseMap<const FunctionDecl *, llvm::Function *> functions;
     std::map<std::string, llvm::Value*> formatStringCache;
     
-    std::unique_ptr<llvm::FunctionPassManager> TheFPM;
+    std::unique_ptr<llvm::TargetMachine> TheTargetMachine;
+    std::unique_ptr<llvm::ModulePassManager> TheMPM;
     std::unique_ptr<llvm::LoopAnalysisManager> TheLAM;
     std::unique_ptr<llvm::FunctionAnalysisManager> TheFAM;
     std::unique_ptr<llvm::CGSCCAnalysisManager> TheCGAM;
     std::unique_ptr<llvm::ModuleAnalysisManager> TheMAM;
-    llvm::Type *GenerateType(std::string type) {
+    llvm::Type *GenerateType(llvm::StringRef type) {
     if (type == "number") {
         return llvm::Type::getDoubleTy(*TheContext);
     } else if (type == "int") {
         return llvm::Type::getInt32Ty(*TheContext);
     } else if (type == "float") {
         return llvm::Type::getDoubleTy(*TheContext);
+    } else if (type == "bool") {
+        return llvm::Type::getInt1Ty(*TheContext);
     } else if (type == "string") {
         return llvm::PointerType::get(*TheContext, 0); 
     } else if (type == "void") {
@@ -47,33 +72,67 @@ class Codegen : public ASTVisitor{
     }
 
     void logError(const char* str);
+
+    llvm::Type *variableType(const Decl &variable);
+    void writeVariable(const Decl &variable, llvm::BasicBlock *block, llvm::Value *value);
+    llvm::Value *readVariable(const Decl &variable, llvm::BasicBlock *block);
+    llvm::Value *readVariableRecursive(const Decl &variable, llvm::BasicBlock *block);
+    llvm::Value *addPhiOperands(const Decl &variable, llvm::PHINode *phi);
+    llvm::Value *tryRemoveTrivialPhi(llvm::PHINode *phi);
+    void sealBlock(llvm::BasicBlock *block);
+    void clearVariables();
+
+    // Bools are i1. One converts to an int (0 or 1) where an int is
+    // expected; a condition is a bool, or an int or float compared to 0.
+    llvm::Value *convert(llvm::Value *value, llvm::Type *type);
+    llvm::Value *toCondition(llvm::Value *value);
+    // Branches on `condition`. `&&` and `||` become a chain of branches,
+    // each evaluating one operand, and never build a bool value.
+    bool emitBranch(Expr &condition, llvm::BasicBlock *trueBB, llvm::BasicBlock *falseBB);
+    llvm::Value *emitLogicalExpr(BinaryExpr &node);
+    // Returns from a void function, or with 0 from a void main.
+    void emitVoidReturn(llvm::Type *returnType);
   
     public:
-    Codegen();
-    void generate(std::vector<std::unique_ptr<FunctionDecl>> & program);
+    // The -O levels: PassBuilder's default pipeline for each, and the
+    // matching backend level. Default, for no -O at all, is the -O0
+    // pipeline with the backend at the level it had before there were
+    // -O levels.
+    enum class OptLevel { Default, O0, O1, O2, O3, Os };
+
+    explicit Codegen(OptLevel level = OptLevel::Default);
+    // Lowers every function, optimizes the module and writes it out.
+    void generate(std::vector<FunctionDecl *> & program);
+    // Runs the optimization pipeline over the whole module, with main as
+    // the only root. Call it before writeIR() after lowering functions one
+    // at a time.
+    void optimize();
+    // Returns the llvm::Function for `function`, creating it without a body
+    // on first use, so that a call can come before the callee is lowered.
+    // The signature must have been checked.
+    llvm::Function *declareFunction(const FunctionDecl &function);
+    // Writes the module to Output.ll.
+    void writeIR();
     bool GenerateObjectFile(std::string filename); 
     llvm::Module* getModule() { return TheModule.get(); }
 
-    void visit(NumberLiteral& node) override;
-    void visit(StringLiteral& node) override ;
-    void visit(BooleanLiteral& node) override;
-    void visit(Block& node) override;
-    void visit(DeclRefExpr& node) override;
-    void visit(CallExpr& node) override; 
-    void visit(Stmt& node) override;
-    void visit(ReturnStmt& node) override;
-    void visit(IfStmt& node) override;
-    void visit(WhileStmt& node) override;
-    void visit(Expr& node) override;
+    // Expressions return their value, or null if there is none (a void
+    // call) or it could not be generated. Statements return null.
+    llvm::Value *visitFunctionDecl(FunctionDecl &node);
+    llvm::Value *visitBlock(Block &node);
+    llvm::Value *visitVariableDecl(VariableDecl &node);
+    llvm::Value *visitReturnStmt(ReturnStmt &node);
+    llvm::Value *visitIfStmt(IfStmt &node);
+    llvm::Value *visitWhileStmt(WhileStmt &node);
 
-    void visit(FunctionDecl& node) override;
-    void visit(ParamDecl& node) override;
-    void visit(Decl& node) override;
-    void visit(VariableDecl& node) override;
-    void visit(PrintExpr& node) override;
-    void visit(BinaryExpr& node) override;
-    void visit(AssignmentExpr& node) override;
-    
+    llvm::Value *visitNumberLiteral(NumberLiteral &node);
+    llvm::Value *visitStringLiteral(StringLiteral &node);
+    llvm::Value *visitBooleanLiteral(BooleanLiteral &node);
+    llvm::Value *visitDeclRefExpr(DeclRefExpr &node);
+    llvm::Value *visitCallExpr(CallExpr &node);
+    llvm::Value *visitPrintExpr(PrintExpr &node);
+    llvm::Value *visitBinaryExpr(BinaryExpr &node);
+    llvm::Value *visitAssignmentExpr(AssignmentExpr &node);
 };
 
 #endif
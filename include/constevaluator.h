@@ -0,0 +1,87 @@
+#ifndef CONSTEVALUATOR_H
+#define CONSTEVALUATOR_H
+
+#include <cstdint>
+#include <optional>
+
+#include "llvm/ADT/DenseMap.h"
+#include "ast.h"
+#include "astcontext.h"
+
+// Folds constant expressions in checked function bodies into literals, so
+// that codegen emits a constant instead of the instructions to compute it.
+//
+// Folding is bottom-up: once every operand of an arithmetic or comparison
+// operator is a literal, the operator is evaluated, with the semantics of
+// the IR codegen would emit for it: 32-bit two's complement ints, doubles,
+// an int operand converted when the other one is a float, a bool operand
+// taken as an int, ordered float comparisons, and comparisons giving a
+// bool. Operations whose result the IR leaves undefined (division by
+// zero, INT_MIN / -1) are not folded and stay to happen at run time. `&&`
+// and `||` fold as soon as their left operand decides them, since the
+// right one would not run.
+//
+// A call whose arguments are all literals is evaluated by interpreting the
+// callee's body, if that is in memory and checked: variables, assignments,
+// if, while, return and further calls. A call that prints, reads a variable
+// before it is set, runs off the end of a function without returning a
+// value, nests calls too deeply, or runs out of the steps left to the body
+// being folded is left as it is. Printing is the only side effect the language has, so a
+// call that evaluates is free of them and can be replaced by its value.
+class ConstantEvaluator {
+public:
+    struct Stats {
+        size_t folded = 0;          // expressions replaced by a literal
+        size_t callsEvaluated = 0;  // of them, calls
+    };
+
+    // Limits on folding one function: statements and expressions run to
+    // evaluate all of the calls in its body, so that a body with many calls
+    // costs no more than one with a single expensive call; and calls nested
+    // inside each other.
+    static constexpr unsigned maxSteps = 100000;
+    static constexpr unsigned maxDepth = 64;
+
+    // New literals are allocated from `context`.
+    explicit ConstantEvaluator(ASTContext &context) : context(context) {}
+
+    void foldFunction(FunctionDecl &function);
+    const Stats &getStats() const { return stats; }
+
+private:
+    struct Value {
+        Type type;  // INT, FLOAT or BOOL; a bool is an intValue of 0 or 1
+        union {
+            int32_t intValue;
+            double floatValue;
+        };
+    };
+    using Frame = llvm::DenseMap<const Decl *, Value>;
+    enum class Flow { Next, Return, Fail };
+
+    ASTContext &context;
+    Stats stats;
+    unsigned steps = 0;
+    unsigned depth = 0;
+
+    Expr *fold(Expr *expr);
+    void foldBlock(Block &block);
+
+    static std::optional<Value> literalValue(const Expr &expr);
+    static std::optional<Value> apply(TokenKind op, Value left, Value right);
+    static bool isTrue(Value value);
+    static Value makeBool(bool value);
+    // A bool stored into an int, as sema allows.
+    static Value convert(Value value, std::optional<Type> type);
+    Expr *makeLiteral(const Expr &expr, Value value);
+
+    // These return false if the evaluation failed. A call to a void
+    // function succeeds with no result.
+    bool call(const FunctionDecl &callee, llvm::ArrayRef<Value> args, std::optional<Value> &result);
+    bool invoke(const CallExpr &expr, Frame &frame, std::optional<Value> &result);
+    std::optional<Value> evaluate(const Expr &expr, Frame &frame);
+    Flow execute(const Block &block, Frame &frame, std::optional<Value> &result);
+    Flow execute(const Stmt &stmt, Frame &frame, std::optional<Value> &result);
+};
+
+#endif
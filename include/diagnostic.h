@@ -0,0 +1,32 @@
+#ifndef DIAGNOSTIC_H
+#define DIAGNOSTIC_H
+
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "llvm/ADT/StringRef.h"
+#include "sourcemanager.h"
+
+// An error that has not been reported yet. Phases that run ahead of the
+// parser or on other threads collect these instead of printing, and the
+// location is only turned into line and column when the error is shown.
+struct Diagnostic {
+    SourceLocation location;
+    std::string message;
+};
+
+// "file:line:col: error: message"
+inline std::string formatDiagnostic(llvm::StringRef file, unsigned line, unsigned col,
+                                    std::string_view message) {
+    std::ostringstream oss;
+    oss << file.str() << ':' << line << ':' << col << ": error: " << message;
+    return oss.str();
+}
+
+inline std::string formatDiagnostic(const SourceManager &SM, const Diagnostic &diag) {
+    const auto &[file, line, col] = SM.getPresumedLoc(diag.location);
+    return formatDiagnostic(file, line, col, diag.message);
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef IDENTIFIERTABLE_H
+#define IDENTIFIERTABLE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
+
+// An interned identifier. Equal spellings get equal ids, so comparing or
+// hashing names is an integer operation, and ids are dense from 1, so
+// they can index arrays directly. Id 0 is no name.
+struct Symbol {
+    uint32_t id = 0;
+
+    bool isValid() const { return id != 0; }
+    bool operator==(Symbol other) const { return id == other.id; }
+    bool operator!=(Symbol other) const { return id != other.id; }
+    bool operator<(Symbol other) const { return id < other.id; }
+
+    // Spelling in the global table, for diagnostics and IR names.
+    llvm::StringRef getSpelling() const;
+    std::string str() const { return getSpelling().str(); }
+};
+
+// Maps spellings to Symbols and back. Spellings are copied into the table,
+// so they outlive the source buffers they were lexed from.
+class IdentifierTable {
+    llvm::StringMap<uint32_t, llvm::BumpPtrAllocator> ids;
+    std::vector<llvm::StringRef> spellings{llvm::StringRef()};  // by id
+
+public:
+    Symbol intern(llvm::StringRef spelling) {
+        auto [entry, inserted] = ids.try_emplace(spelling, static_cast<uint32_t>(spellings.size()));
+        if (inserted) spellings.push_back(entry->getKey());
+        return Symbol{entry->second};
+    }
+
+    llvm::StringRef getSpelling(Symbol symbol) const { return spellings[symbol.id]; }
+    // One past the largest id handed out.
+    size_t size() const { return spellings.size(); }
+
+    // The table shared by every phase of the compilation. The lexer interns
+    // into it; parallel lexing interns into per-chunk tables and merges them
+    // in afterwards, so it is only ever written from one thread.
+    static IdentifierTable &global();
+};
+
+inline llvm::StringRef Symbol::getSpelling() const {
+    return IdentifierTable::global().getSpelling(*this);
+}
+
+#endif
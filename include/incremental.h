@@ -0,0 +1,119 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "ast.h"
+#include "astcontext.h"
+#include "diagnostic.h"
+#include "identifiertable.h"
+#include "sourcemanager.h"
+
+// One change to a document: `removedLength` bytes at `offset` are replaced
+// by `insertedText`.
+struct TextEdit {
+    size_t offset = 0;
+    size_t removedLength = 0;
+    std::string insertedText;
+};
+
+// Reads an edit script: one edit per line, "<offset> <removed length>
+// <inserted text>", where the text may use \n, \t and \\. Blank lines and
+// lines starting with '#' are skipped. Returns false, with the 1-based
+// number of the first malformed line in `badLine`, if there is one.
+bool parseEditScript(llvm::StringRef script, std::vector<TextEdit> &edits, unsigned &badLine);
+
+// Keeps the front end's view of one open document (its ASTs and
+// diagnostics) up to date as edits come in, for editors.
+//
+// The file is cut into units, one per iteration of the parser's top-level
+// loop: a function, or the tokens skipped before the next 'func'. Between
+// iterations the parser holds nothing but its lookahead token, and the
+// lexer nothing at all. So an edit only has to re-lex and re-parse from the
+// unit it lands in until the parser starts an iteration exactly where an
+// old unit past the edit starts; from there on both are back in step with
+// the old parse and the remaining units are kept. The result is the same
+// as parsing the whole new text.
+//
+// Sema checks functions one by one. After an edit it re-checks the
+// re-parsed functions, and those whose last check looked up a name in the
+// global scope that a re-parsed function declares or used to declare.
+// Unlike a whole-program run, it does not stop at the first error: every
+// function reports its own.
+//
+// Diagnostics keep the locations of the text they were found in and are
+// moved into the current text, relative to their unit, when reported.
+// Each version of the text gets a SourceManager of its own, and the units
+// own the ASTContexts they were parsed into, so neither location space nor
+// AST memory grows with the number of edits. The global IdentifierTable
+// does grow: it keeps every distinct spelling ever lexed, such as each
+// prefix of a name typed one character at a time, until the process ends.
+class IncrementalFrontend {
+public:
+    // Work done by the last update.
+    struct Stats {
+        size_t bytesLexed = 0;
+        size_t unitsParsed = 0;
+        size_t functionsChecked = 0;
+    };
+
+    IncrementalFrontend(std::string path, std::string text);
+
+    void applyEdit(const TextEdit &edit);
+
+    const std::string &getText() const { return text; }
+    // Lexer and parser diagnostics in file order, then sema diagnostics:
+    // signatures first, then bodies, as in a whole-program run.
+    std::vector<std::string> getDiagnostics() const;
+    // Every function of the document, in file order.
+    std::vector<FunctionDecl *> getFunctions() const;
+    // Where each unit starts in the current text, in file order. Each is
+    // the offset of a token: the one the parser's top-level loop started on.
+    std::vector<size_t> getUnitOffsets() const;
+    const Stats &getStats() const { return stats; }
+
+private:
+    struct CheckedFunction {
+        FunctionDecl *decl;
+        bool needsCheck = true;
+        bool signatureResolved = false;
+        std::vector<Diagnostic> signatureDiagnostics;
+        std::vector<Diagnostic> bodyDiagnostics;
+        std::vector<Symbol> globalLookups;  // sorted, unique
+    };
+
+    struct Unit {
+        size_t begin = 0;          // offset in the current text
+        uint32_t parsedBase = 0;   // location of `begin` in the text it was parsed from
+        // End of the token the unit starts with, relative to `begin`. The
+        // previous unit's parse ended on it as lookahead.
+        size_t leadLength = 0;
+        std::vector<Diagnostic> lexerDiagnostics;   // located in this unit
+        std::vector<Diagnostic> parserDiagnostics;  // raised while parsing it
+        std::vector<CheckedFunction> functions;
+        // Shared by the units parsed in the same update.
+        std::shared_ptr<ASTContext> context;
+    };
+
+    std::string path;
+    std::string text;
+    std::unique_ptr<SourceManager> sourceManager;
+    const SourceFile *file = nullptr;
+    std::vector<Unit> units;
+    Stats stats;
+
+    void loadText();
+    // Re-parses after [offset, removedEnd) of the old text was replaced by
+    // `delta` more bytes (or fewer), then re-checks.
+    void update(size_t offset, size_t removedEnd, ptrdiff_t delta);
+    void check(llvm::ArrayRef<Symbol> changedNames);
+    size_t currentOffset(const Unit &unit, SourceLocation location) const;
+    void report(std::vector<std::string> &out, const Unit &unit,
+                const Diagnostic &diag) const;
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef LAZYFRONTEND_H
+#define LAZYFRONTEND_H
+
+#include <vector>
+
+#include "ast.h"
+#include "astcontext.h"
+#include "diagnostic.h"
+#include "parallellexer.h"
+
+// Parses, checks and hands to codegen only the functions that main can
+// reach, for programs that carry large libraries of functions and call
+// few of them.
+//
+// The first pass parses signatures only; each body is skipped from its
+// '{' to the matching '}'. Then, starting at main, each body is parsed on
+// demand and the functions it calls join the queue. Once no more are
+// reached, the reached bodies are checked in file order, as a whole-program
+// run checks them. A function that is never reached is parsed no further
+// than its signature and is never checked or lowered, and errors in its
+// body go unreported. Lexer errors are the exception: the whole file is
+// lexed, so they are all reported.
+class LazyFrontend {
+public:
+    struct Stats {
+        size_t functions = 0;
+        size_t bodiesParsed = 0;
+        size_t constantsFolded = 0;
+    };
+
+    // Nodes are allocated from `context`, which must outlive them.
+    LazyFrontend(const TokenBuffer &tokens, ASTContext &context)
+        : tokens(tokens), context(context) {}
+
+    // Every function in file order, without bodies.
+    std::vector<FunctionDecl *> parseSignatures();
+    // Checks every signature, then parses and checks the bodies reachable
+    // from main. Stops at the first error, like SemanticAnalysis::resolve.
+    bool check();
+    // The functions reached by check(), in file order, with their bodies.
+    std::vector<FunctionDecl *> getReachableFunctions() const;
+    const Stats &getStats() const { return stats; }
+    // Folds constants in the reached bodies once they are all checked, so
+    // that calls can be evaluated into any of them.
+    void setConstantFolding(bool fold) { foldConstants = fold; }
+
+private:
+    const TokenBuffer &tokens;
+    ASTContext &context;
+    std::vector<FunctionDecl *> functions;
+    std::vector<bool> reached;  // by index in `functions`
+    Stats stats;
+    bool foldConstants = false;
+
+    bool parseBody(FunctionDecl &function, std::vector<Diagnostic> &diagnostics);
+};
+
+#endif
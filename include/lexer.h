@@ -1,63 +1,110 @@
 #ifndef LEXER_H
 #define LEXER_H
 #include<string>
+#include <string_view>
 #include <vector>
+#include "llvm/ADT/StringRef.h"
+#include "diagnostic.h"
+#include "sourcemanager.h"
 #include "token.h"
 #include "utils.h"
 
-class TheLexer{
-  private:
+// The keyword `id` spells, or TokenKind::identifier if it is not one.
+TokenKind classifyIdentifier(std::string_view id);
+
+// Where the parser pulls tokens from: the lexer itself, or a buffer of
+// tokens lexed ahead of time (see parallellexer.h).
+class TokenSource {
+  protected:
+  const SourceManager *SM;
   const SourceFile *sourceFile;
-  size_t idx=0;
-  int line =0;
-  int column =0 ;
-  char lastChar = ' ';
-  SourceLocation getSourceLocation(){
-    return SourceLocation{sourceFile->path, line, column};
+
+  TokenSource(const SourceManager &SM, const SourceFile &sourceFile): SM(&SM), sourceFile(&sourceFile){}
+
+  public:
+  virtual ~TokenSource() = default;
+  virtual Token getNextToken() = 0;
+  // Starts the stream over from the first token.
+  virtual void rewind() = 0;
+
+  const SourceManager &getSourceManager() const { return *SM; }
+  // Raw source text of a token.
+  llvm::StringRef getSpelling(const Token &tok) const {
+    return sourceFile->buffer.substr(sourceFile->getOffset(tok.location), tok.length);
   }
-  int peekNextChar() { 
-     if (idx >= sourceFile->buffer.size()) return EOF;
-     return static_cast<unsigned char>(sourceFile->buffer[idx]); 
-}
-int getNextChar(){
-    if (idx >= sourceFile->buffer.size()) return EOF;
-    lastChar = sourceFile->buffer[idx++]; 
-
-    if(lastChar == '\n'){ 
-        ++line;
-        column=0;
-    }else {
-        column++;
-    }
-    return static_cast<unsigned char>(lastChar); 
-}
-  public :
-  explicit TheLexer (const SourceFile &sourceFile): sourceFile(&sourceFile){}
-  Token getNextToken();
+  // Contents of a string literal without its quotes. Literals without
+  // escape sequences are returned as a view into the source; only those
+  // with escapes are decoded, into `storage`.
+  llvm::StringRef getStringValue(const Token &tok, std::string &storage) const;
 
   void debugPrintAllTokens() {
         std::cout << "\n----------lexer----------\n" << std::endl;
-        
-        std::vector<Token> tokens;
+
+        size_t count = 0;
         Token tok = getNextToken();
-        
+
         while (tok.kind != TokenKind::eof) {
-            tok.print();
-            tokens.push_back(tok);
+            tok.print(*SM);
+            ++count;
             tok = getNextToken();
         }
-        
+
         // Print EOF token
-        tok.print();
-        
-        std::cout << "\n-------- TOTAL TOKENS:" << tokens.size() + 1 
+        tok.print(*SM);
+
+        std::cout << "\n-------- TOTAL TOKENS:" << count + 1
                   << "------------\n" << std::endl;
-        
-        // Reset lexer state for reuse
-        idx = 0;
-        line = 0;
-        column = 0;
+
+        // Reset state for reuse
+        rewind();
     }
 };
 
-#endif
\ No newline at end of file
+class TheLexer : public TokenSource {
+  private:
+  // The part of the file being lexed: all of it, or one chunk of it.
+  llvm::StringRef buffer;
+  size_t beginIdx = 0;
+  size_t idx = 0;
+  std::vector<Diagnostic> *diagnosticBuffer = nullptr;
+  IdentifierTable *identifiers = &IdentifierTable::global();
+
+  bool atEnd() const { return idx >= buffer.size(); }
+  char peekChar(size_t ahead = 0) const {
+     size_t pos = idx + ahead;
+     if (pos >= buffer.size()) return '\0';
+     return buffer[pos];
+  }
+  void advance(){ ++idx; }
+  Token formToken(TokenKind kind, size_t start) const {
+    size_t length = idx - start;
+    if (length > Token::maxLength) {
+      error(start, "token is too long");
+      length = Token::maxLength;
+    }
+    return Token{sourceFile->getLocation(start), static_cast<uint32_t>(length), kind};
+  }
+  void skipWhitespaceAndComments();
+  Token lexNumber(size_t start);
+  void error(size_t offset, std::string_view message) const;
+
+  public :
+  TheLexer (const SourceManager &SM, const SourceFile &sourceFile)
+    : TokenSource(SM, sourceFile), buffer(sourceFile.buffer){}
+  // Lexes only [begin, end) of the file. Both ends must lie between tokens,
+  // outside of strings and comments; the range then yields exactly the
+  // tokens a whole-file lexer produces there, followed by an eof at `end`.
+  TheLexer (const SourceManager &SM, const SourceFile &sourceFile, size_t begin, size_t end)
+    : TokenSource(SM, sourceFile), buffer(sourceFile.buffer.substr(0, end)),
+      beginIdx(begin), idx(begin){}
+
+  Token getNextToken() override;
+  void rewind() override { idx = beginIdx; }
+
+  // Collects diagnostics into `buffer` instead of printing them.
+  void setDiagnosticBuffer(std::vector<Diagnostic> *buffer) { diagnosticBuffer = buffer; }
+  // Interns identifiers into `table` instead of the global one.
+  void setIdentifierTable(IdentifierTable *table) { identifiers = table; }
+};
+
+#endif
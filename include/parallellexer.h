@@ -0,0 +1,78 @@
+#ifndef PARALLELLEXER_H
+#define PARALLELLEXER_H
+
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/StringRef.h"
+#include "lexer.h"
+
+// Offsets at which lexing can start from scratch: 0, then the byte after
+// the first newline past every `chunkSize` bytes that lies outside strings
+// and comments. Found by a quick sequential pass that only tracks string
+// and comment state.
+std::vector<size_t> findChunkBoundaries(llvm::StringRef buffer, size_t chunkSize);
+
+// All tokens of a file, lexed up front. With `threads` > 1 the file is cut
+// at findChunkBoundaries, the chunks are lexed on a thread pool and their
+// token arrays are read back to back, giving the same token stream as the
+// on-demand lexer. Lexer diagnostics are held back and printed when the
+// stream reaches the token that raised them, so they interleave with
+// parser diagnostics exactly as before.
+class TokenBuffer : public TokenSource {
+    struct PendingDiagnostic {
+        size_t tokenIndex;
+        Diagnostic diag;
+    };
+    struct ReadPosition {
+        size_t chunk = 0, index = 0;  // next token to return
+        size_t position = 0;          // its index in the whole stream
+        size_t nextDiagnostic = 0;
+    };
+    // Non-empty token arrays in file order; the last one ends with eof.
+    std::vector<std::vector<Token>> chunks;
+    std::vector<size_t> chunkBegins;  // stream index of each chunk's first token
+    std::vector<PendingDiagnostic> diagnostics;
+    size_t numTokens = 0;
+    ReadPosition current;
+
+    Token read(ReadPosition &at, std::vector<Diagnostic> *diagnosticBuffer) const;
+
+public:
+    TokenBuffer(const SourceManager &SM, const SourceFile &sourceFile, unsigned threads);
+
+    Token getNextToken() override { return read(current, nullptr); }
+    void rewind() override { current = ReadPosition{}; }
+
+    size_t size() const { return numTokens; }
+    const std::vector<std::vector<Token>> &getChunks() const { return chunks; }
+    // Index of the token that starts at `location`.
+    size_t findToken(SourceLocation location) const;
+
+    // Reads the stream from token `start` on, independently of the
+    // buffer's own position, so that several threads can read one buffer
+    // at once. The lexer diagnostics of token `start` itself are left out:
+    // they were reported by whoever read up to it as lookahead.
+    class Cursor : public TokenSource {
+        const TokenBuffer *tokens;
+        ReadPosition begin, at;
+        size_t lastIndex;
+        std::vector<Diagnostic> *diagnosticBuffer = nullptr;
+
+    public:
+        Cursor(const TokenBuffer &tokens, size_t start);
+
+        Token getNextToken() override {
+            lastIndex = at.position;
+            return tokens->read(at, diagnosticBuffer);
+        }
+        void rewind() override { at = begin; }
+
+        // Index of the token returned last.
+        size_t getLastIndex() const { return lastIndex; }
+        // Collects diagnostics into `buffer` instead of printing them.
+        void setDiagnosticBuffer(std::vector<Diagnostic> *buffer) { diagnosticBuffer = buffer; }
+    };
+};
+
+#endif
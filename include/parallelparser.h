@@ -0,0 +1,65 @@
+#ifndef PARALLELPARSER_H
+#define PARALLELPARSER_H
+
+#include <vector>
+
+#include "ast.h"
+#include "astcontext.h"
+#include "diagnostic.h"
+#include "parallellexer.h"
+
+// Token indices at which the parser's top-level loop is likely to start an
+// iteration: 0, then the first 'func' outside of braces past every
+// `rangeSize` tokens. Found by a pass over the token kinds that only counts
+// braces.
+std::vector<size_t> findFunctionBoundaries(const TokenBuffer &tokens, size_t rangeSize);
+
+// Parses a TokenBuffer like Parser::parseProgram, with the ranges between
+// findFunctionBoundaries parsed on a thread pool, each into an ASTContext
+// and a diagnostic list of its own.
+//
+// Between top-level iterations the parser holds nothing but its lookahead
+// token, so a range parsed from its first token gives exactly what the
+// sequential parse gives there, provided that parse also starts an
+// iteration at that token. The ranges are taken in file order as long as
+// each one ends where the next begins. Where one runs on, as error
+// recovery after an unbalanced brace can, the text up to the next range
+// that lines up again is parsed once more, on the calling thread. So the
+// functions, and the diagnostics with them, come out the same and in the
+// same order as from a sequential parse.
+class ParallelParser {
+public:
+    struct Stats {
+        size_t ranges = 0;           // parsed on the thread pool
+        size_t rangesReparsed = 0;   // parsed again after a range ran on
+    };
+
+    // Nodes are allocated from `context` and its sub-contexts.
+    ParallelParser(const TokenBuffer &tokens, ASTContext &context, unsigned threads)
+        : tokens(tokens), context(context), threads(threads) {}
+
+    std::vector<FunctionDecl *> parseProgram();
+    // Collects diagnostics into `buffer` instead of printing them.
+    void setDiagnosticBuffer(std::vector<Diagnostic> *buffer) { diagnosticBuffer = buffer; }
+    const Stats &getStats() const { return stats; }
+
+private:
+    struct ParsedRange {
+        std::vector<FunctionDecl *> functions;
+        std::vector<Diagnostic> diagnostics;  // lexer and parser, as raised
+        size_t end = 0;                       // token the last iteration stopped at
+        bool atEnd = false;                   // that token is eof
+    };
+
+    const TokenBuffer &tokens;
+    ASTContext &context;
+    unsigned threads;
+    std::vector<Diagnostic> *diagnosticBuffer = nullptr;
+    Stats stats;
+
+    // Runs top-level iterations from token `start` until one ends at or
+    // past token `stop`, or at eof.
+    ParsedRange parseRange(size_t start, size_t stop, ASTContext &rangeContext) const;
+};
+
+#endif
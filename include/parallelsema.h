@@ -0,0 +1,53 @@
+#ifndef PARALLELSEMA_H
+#define PARALLELSEMA_H
+
+#include <vector>
+
+#include "ast.h"
+#include "astcontext.h"
+#include "diagnostic.h"
+#include "sourcemanager.h"
+
+// Checks a program like SemanticAnalysis::resolve, with the bodies checked
+// on a thread pool.
+//
+// Signatures are checked first, on the calling thread, into one global
+// scope, which is then frozen. The bodies are split into runs of
+// consecutive functions, each checked by a SemanticAnalysis of its own
+// that reads the frozen scope without locking and keeps its local scopes
+// and diagnostics to itself. A body writes only its own nodes. A run stops
+// at its first failing body, and runs past the earliest failure found so
+// far are abandoned. Only the diagnostics of the first failing body in
+// file order are reported, so the output is the same as from resolve().
+class ParallelSema {
+public:
+    struct Stats {
+        size_t runs = 0;
+        size_t constantsFolded = 0;
+    };
+
+    ParallelSema(std::vector<FunctionDecl *> &functions, const SourceManager &SM,
+                 unsigned threads)
+        : functions(functions), SM(SM), threads(threads) {}
+
+    bool resolve();
+    const Stats &getStats() const { return stats; }
+    // Folds constants with literals from `context` once every body is
+    // checked. Folding runs on the calling thread: a call is evaluated by
+    // reading the callee's body, which another thread could be folding.
+    void setConstantFolding(ASTContext *context) { foldingContext = context; }
+
+private:
+    struct CheckedRun {
+        std::vector<Diagnostic> diagnostics;
+        bool ok = true;
+    };
+
+    std::vector<FunctionDecl *> &functions;
+    const SourceManager &SM;
+    unsigned threads;
+    Stats stats;
+    ASTContext *foldingContext = nullptr;
+};
+
+#endif
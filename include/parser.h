@@ -7,41 +7,61 @@
 #include "lexer.h"
 #include "utils.h"
 #include "ast.h"
+#include "astcontext.h"
 
 class Parser{
-    TheLexer *lexer;
+    TokenSource *lexer;
+    ASTContext *context;
     Token nextToken;
     std::vector<std::string> diagnostics;
+    std::vector<Diagnostic> *diagnosticBuffer = nullptr;
+    bool skipFunctionBodies = false;
     void skipToken(){ nextToken=lexer->getNextToken();}
     bool skipUntil(std::initializer_list<TokenKind> kinds);
+    bool skipBraces();
     void error(SourceLocation location,std::string_view message);
     
 
-    std::unique_ptr<Expr> parseParenExpr();
-    std::unique_ptr<Expr> parseNumberExpr() ;
-    std::unique_ptr<Expr> parseExpr();
-    std::unique_ptr<Expr> parseStringExpr();
-    std::unique_ptr<Expr> parsePrintExpr();
-    std::unique_ptr<Expr> parseIdentifierExpr();
-    std::unique_ptr<Stmt> parseReturnStmt();
+    Expr *parseParenExpr();
+    Expr *parseNumberExpr() ;
+    Expr *parseExpr();
+    Expr *parseStringExpr();
+    Expr *parsePrintExpr();
+    Expr *parseIdentifierExpr();
+    Stmt *parseReturnStmt();
     
     int getTokPrecedence();
-    std::unique_ptr<Expr> parsePrimaryExpr();
-    std::unique_ptr<Expr> parseBinaryExpr(int exprPrec, std::unique_ptr<Expr> lhs);
+    Expr *parsePrimaryExpr();
+    Expr *parseBinaryExpr(int exprPrec, Expr *lhs);
     
-    std::unique_ptr<ParamDecl> parseParams(); 
-    std::unique_ptr<Block> parseBlock();
-    std::unique_ptr<Stmt> parseStmt();
-    std::unique_ptr<VariableDecl> parseVariableDecl();
-    std::unique_ptr<FunctionDecl> parseFunction();
-    std::unique_ptr<Stmt> parseIfStmt();
-    std::unique_ptr<Stmt> parseWhileStmt();
-    std::unique_ptr<Expr> parseBooleanExpr();
+    ParamDecl *parseParams(); 
+    Block *parseBlock();
+    Stmt *parseStmt();
+    VariableDecl *parseVariableDecl();
+    FunctionDecl *parseFunction();
+    Stmt *parseIfStmt();
+    Stmt *parseWhileStmt();
+    Expr *parseBooleanExpr();
     
     
    public:
-    explicit Parser(TheLexer &lexer): lexer(&lexer), nextToken(lexer.getNextToken()){}
-    std::vector<std::unique_ptr<FunctionDecl>> parseProgram();
+    // Nodes are allocated from `context`, which must outlive them.
+    Parser(TokenSource &lexer, ASTContext &context)
+        : lexer(&lexer), context(&context), nextToken(lexer.getNextToken()){}
+    std::vector<FunctionDecl *> parseProgram();
+    // One iteration of parseProgram's loop: a function, or the tokens
+    // skipped up to the next 'func'. The parser carries nothing from one
+    // iteration to the next except the lookahead token.
+    void parseTopLevelDecl(std::vector<FunctionDecl *> &functions);
+    const Token &peekToken() const { return nextToken; }
+    // Collects diagnostics into `buffer` instead of printing them.
+    void setDiagnosticBuffer(std::vector<Diagnostic> *buffer) { diagnosticBuffer = buffer; }
+    // Leaves function bodies out: the tokens from '{' to the matching '}'
+    // are skipped and FunctionDecl::body is left null, for parseBody to
+    // fill in later.
+    void setSkipFunctionBodies(bool skip) { skipFunctionBodies = skip; }
+    // Parses a body skipped earlier. The lookahead must be its '{'.
+    Block *parseBody() { return parseBlock(); }
 };
 
 
@@ -0,0 +1,73 @@
+#ifndef PIPELINEDLEXER_H
+#define PIPELINEDLEXER_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "lexer.h"
+
+// Runs the lexer on its own thread, ahead of the parser. Tokens are handed
+// over in batches through a fixed ring of slots with one producer and one
+// consumer, synchronized by two atomic counters. When the parser falls
+// behind, the lexer waits for a free slot, so at most ringSize * batchSize
+// tokens are ever buffered, however large the input. A side that has to
+// wait spins briefly and then sleeps until the other moves its counter.
+//
+// The lexer thread interns identifiers into the global IdentifierTable
+// while the parser runs; the parser only reads Symbol ids, never
+// spellings, so the two do not share anything else.
+class PipelinedLexer : public TokenSource {
+    static constexpr size_t batchSize = 1024;  // tokens per slot
+    static constexpr size_t ringSize = 64;     // slots
+
+    struct Batch {
+        std::array<Token, batchSize> tokens;
+        size_t count = 0;
+        // Lexer diagnostics with the index of the token that raised them,
+        // printed when the parser reaches it.
+        std::vector<std::pair<size_t, Diagnostic>> diagnostics;
+    };
+
+    TheLexer lexer;
+    std::unique_ptr<Batch[]> ring;
+    // Batches published by the lexer / released by the parser. Each is
+    // written by one side only, and they sit on separate cache lines.
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+    std::atomic<bool> stopRequested{false};
+    std::thread producer;
+    // Only one side can be waiting at a time: the ring cannot be both full
+    // and empty.
+    std::mutex waitMutex;
+    std::condition_variable counterMoved;
+
+    // Parser side.
+    Batch *current = nullptr;
+    size_t index = 0;
+    size_t nextDiagnostic = 0;
+
+    void produce();
+    void start();
+    void stop();
+    template <typename Ready> void waitUntil(Ready ready);
+    void wakeWaiter();
+
+public:
+    PipelinedLexer(const SourceManager &SM, const SourceFile &sourceFile);
+    ~PipelinedLexer() override { stop(); }
+    PipelinedLexer(const PipelinedLexer &) = delete;
+    PipelinedLexer &operator=(const PipelinedLexer &) = delete;
+
+    Token getNextToken() override;
+    // Stops the lexer thread and starts it over from the beginning.
+    void rewind() override;
+};
+
+#endif
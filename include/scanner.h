@@ -0,0 +1,35 @@
+#ifndef SCANNER_H
+#define SCANNER_H
+
+// Run scanners for the lexer's hot loops. Each function looks at [p, end)
+// and returns a pointer to the first byte that ends the run, or `end`.
+// SSE2 and AVX2 versions process 16 or 32 bytes per step; the version is
+// picked once from the host CPU and can be overridden (e.g. to diff the
+// vector paths against the scalar one).
+namespace scan {
+
+enum class ISA { Auto, Scalar, SSE2, AVX2 };
+
+// Selects the implementation used by the functions below. `Auto` picks the
+// best one the CPU supports; requesting an unsupported one falls back to
+// the best supported one below it. Returns the implementation in use.
+ISA selectISA(ISA isa);
+ISA activeISA();
+const char *isaName(ISA isa);
+
+// First byte that is not ' ', '\t', '\n', '\v', '\f' or '\r'.
+const char *skipWhitespace(const char *p, const char *end);
+// First '\n'.
+const char *findNewline(const char *p, const char *end);
+// The '*' of the first "*/".
+const char *findBlockCommentEnd(const char *p, const char *end);
+// First byte that is not [A-Za-z0-9_].
+const char *skipIdentifierChars(const char *p, const char *end);
+// First `quote`, or first '\\' as well when `quote` is '"'.
+const char *findStringDelimiter(const char *p, const char *end, char quote);
+// First byte that may open a string or a comment: '"', '\'', '#' or '/'.
+const char *findStringOrCommentStart(const char *p, const char *end);
+
+}
+
+#endif
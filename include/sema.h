@@ -1,51 +1,125 @@
 #ifndef SEMANTIC_ANALYSIS
 #define SEMANTIC_ANALYSIS
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <memory>
 #include <optional>
 
 #include "ast.h"
+#include "astcontext.h"
+#include "constevaluator.h"
+#include "diagnostic.h"
+#include "sourcemanager.h"
 
 class SemanticAnalysis {
-    std::vector<std::unique_ptr<FunctionDecl>> &TopLevel;
-    std::vector<std::vector<Decl *>> scopes;
+    std::vector<FunctionDecl *> *TopLevel = nullptr;
+    const SourceManager &SM;
+    // The names in scope. Symbols are dense ids, so the table is a vector
+    // indexed by Symbol::id holding each name's innermost declaration and
+    // the depth of its scope (the global scope is 1). Declaring a name logs
+    // the binding it shadows; leaving a scope restores the bindings logged
+    // since it was entered. Lookup, declaration and leaving are O(1) per
+    // name.
+    struct Binding {
+        Decl *decl = nullptr;
+        uint32_t depth = 0;
+    };
+    struct Shadowed {
+        Symbol name;
+        Binding previous;
+    };
+    std::vector<Binding> bindings;
+    std::vector<Shadowed> undoLog;
+    std::vector<size_t> scopeStarts;  // undoLog size when each scope was entered
+    // The global scope of another instance, read but never written, for
+    // checking bodies on several threads at once; see the constructor.
+    const std::vector<Binding> *frozenGlobals = nullptr;
     std::vector<std::string> diagnostics;
+    std::vector<Diagnostic> *diagnosticBuffer = nullptr;
+    std::vector<Symbol> *globalLookups = nullptr;
     FunctionDecl* currentFunction = nullptr;
+    ASTContext *foldingContext = nullptr;
+    ConstantEvaluator::Stats foldStats;
     
     void error(SourceLocation location, std::string_view message) {
-        const auto& [file, line, col] = location;
-        std::ostringstream oss;
-        oss << file << ':' << line << ':' << col << ": error: " << message;
-        diagnostics.push_back(oss.str());
-        std::cerr << oss.str() << "\n";
+        Diagnostic diag{location, std::string(message)};
+        if (diagnosticBuffer) {
+            diagnosticBuffer->push_back(std::move(diag));
+            return;
+        }
+        std::string formatted = formatDiagnostic(SM, diag);
+        diagnostics.push_back(formatted);
+        std::cerr << formatted << "\n";
     }
 
-    Decl *lookupDecl(const std::string &id) {
-        for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
-            for (auto &&decl : *it) {
-                if (decl->identifier == id) {
-                    return decl;
-                }
-            }
+    void pushScope() { scopeStarts.push_back(undoLog.size()); }
+    void popScope() {
+        size_t start = scopeStarts.back();
+        scopeStarts.pop_back();
+        while (undoLog.size() > start) {
+            bindings[undoLog.back().name.id] = undoLog.back().previous;
+            undoLog.pop_back();
         }
-        return nullptr;
+    }
+    void popScopesTo(size_t depth) {
+        while (scopeStarts.size() > depth) popScope();
+    }
+
+    void declare(Decl &decl) {
+        Symbol name = decl.identifier;
+        if (name.id >= bindings.size())
+            bindings.resize(std::max<size_t>(name.id + 1, IdentifierTable::global().size()));
+        Binding &binding = bindings[name.id];
+        uint32_t depth = static_cast<uint32_t>(scopeStarts.size());
+        // Within one scope the first declaration of a name is the one found,
+        // as for a function defined twice.
+        if (binding.decl && binding.depth == depth) return;
+        undoLog.push_back({name, binding});
+        binding = {&decl, depth};
+    }
+
+    Decl *lookupDecl(Symbol id) {
+        Binding binding;
+        if (id.id < bindings.size()) binding = bindings[id.id];
+        if (!binding.decl && frozenGlobals && id.id < frozenGlobals->size())
+            binding = (*frozenGlobals)[id.id];
+        if (globalLookups && (!binding.decl || binding.depth == 1))
+            globalLookups->push_back(id);
+        return binding.decl;
     }
     
-    std::optional<Type> resolveType(const std::string &typeSpecifier) {
+    std::optional<Type> resolveType(llvm::StringRef typeSpecifier) {
         if (typeSpecifier == "void") return Type::VOID;
         if (typeSpecifier == "string") return Type::STRING;
         if (typeSpecifier == "number") return Type::FLOAT; // Default number to float for now if generic
         if (typeSpecifier == "int") return Type::INT;
         if (typeSpecifier == "float") return Type::FLOAT;
+        if (typeSpecifier == "bool") return Type::BOOL;
         return std::nullopt;
     }
 
+    // Comparisons and logical operators give a bool. They used to give an
+    // int, so a bool converts to one, 0 or 1, wherever an int is expected:
+    // as an operand of arithmetic, or assigned, passed or returned as an
+    // int. Nothing else converts; an int is not a bool, nor a bool a float.
+    static bool isConvertible(std::optional<Type> from, std::optional<Type> to) {
+        return from == to || (from == Type::BOOL && to == Type::INT);
+    }
+    static bool isNumeric(std::optional<Type> type) {
+        return type == Type::INT || type == Type::FLOAT || type == Type::BOOL;
+    }
+    // What if, while, && and || accept: an int compared to 0, as always, or
+    // a bool. Floats and strings are rejected, as they always were.
+    static bool isCondition(std::optional<Type> type) {
+        return type == Type::BOOL || type == Type::INT;
+    }
+
     bool resolveDeclRefExpr(DeclRefExpr &DRE) {
         Decl *decl = lookupDecl(DRE.identifier);
         if (!decl) {
-            error(DRE.location, "symbol '" + DRE.identifier + "' not found");
+            error(DRE.location, "symbol '" + DRE.identifier.str() + "' not found");
             return false;
         }
         DRE.resolvedDecl = decl;
@@ -73,11 +147,11 @@ class SemanticAnalysis {
  
         Decl *decl = lookupDecl(cexpr.identifier);
         if (!decl) {
-            error(cexpr.location, "function '" + cexpr.identifier + "' not found");
+            error(cexpr.location, "function '" + cexpr.identifier.str() + "' not found");
             return false;
         }
         
-        auto functionDecl = dynamic_cast<FunctionDecl *>(decl);
+        auto functionDecl = llvm::dyn_cast<FunctionDecl>(decl);
         if (!functionDecl) {
             error(cexpr.location, "calling non-function element");
             return false;
@@ -94,9 +168,9 @@ class SemanticAnalysis {
                 return false;
             }
             
-            if (cexpr.arguments[idx]->resolvedType != functionDecl->params[idx]->resolvedType) {
+            if (!isConvertible(cexpr.arguments[idx]->resolvedType, functionDecl->params[idx]->resolvedType)) {
                 error(cexpr.arguments[idx]->location, 
-                      "unexpected type of argument in " + functionDecl->identifier + " function call");
+                      "unexpected type of argument in " + functionDecl->identifier.str() + " function call");
                 return false;
             }
         }
@@ -120,11 +194,10 @@ class SemanticAnalysis {
             bexpr.op == TokenKind::mul || bexpr.op == TokenKind::slash ||
             bexpr.op == TokenKind::percent) {
             
-            Type leftType = *bexpr.left->resolvedType;
-            Type rightType = *bexpr.right->resolvedType;
+            std::optional<Type> leftType = bexpr.left->resolvedType;
+            std::optional<Type> rightType = bexpr.right->resolvedType;
 
-            if ((leftType != Type::INT && leftType != Type::FLOAT) ||
-                (rightType != Type::INT && rightType != Type::FLOAT)) {
+            if (!isNumeric(leftType) || !isNumeric(rightType)) {
                 error(bexpr.location, "operands of arithmetic operator must be numbers");
                 return false;
             }
@@ -137,38 +210,33 @@ class SemanticAnalysis {
             return true;
         }
         
-        // For comparison operations, both operands must be numbers, result is number (0 or 1)
-        // For comparison operations
+        // For comparison operations, both operands must be numbers, result is a bool
         if (bexpr.op == TokenKind::lessthan || bexpr.op == TokenKind::greaterthan ||
             bexpr.op == TokenKind::less_equal || bexpr.op == TokenKind::great_equal ||
             bexpr.op == TokenKind::doublequal || bexpr.op == TokenKind::not_equal) {
             
-            Type leftType = *bexpr.left->resolvedType;
-            Type rightType = *bexpr.right->resolvedType;
+            std::optional<Type> leftType = bexpr.left->resolvedType;
+            std::optional<Type> rightType = bexpr.right->resolvedType;
 
-            if ((leftType != Type::INT && leftType != Type::FLOAT) ||
-                (rightType != Type::INT && rightType != Type::FLOAT)) {
+            if (!isNumeric(leftType) || !isNumeric(rightType)) {
                 error(bexpr.location, "operands of comparison operator must be numbers");
                 return false;
             }
-            // Comparisons return a boolean, represented as INT (0 or 1)
-            bexpr.resolvedType = Type::INT;
+            bexpr.resolvedType = Type::BOOL;
             return true;
         }
         
-        // For logical operations
-        // For logical operations
+        // For logical operations, operands are conditions, result is a bool
         if (bexpr.op == TokenKind::amp_amp || bexpr.op == TokenKind::pipe_pipe) {
-            // Logical operations work on integers (treated as booleans)
-            if (bexpr.left->resolvedType != Type::INT) {
+            if (!isCondition(bexpr.left->resolvedType)) {
                 error(bexpr.left->location, "left operand of logical operator must be an integer (boolean)");
                 return false;
             }
-            if (bexpr.right->resolvedType != Type::INT) {
+            if (!isCondition(bexpr.right->resolvedType)) {
                 error(bexpr.right->location, "right operand of logical operator must be an integer (boolean)");
                 return false;
             }
-            bexpr.resolvedType = Type::INT;
+            bexpr.resolvedType = Type::BOOL;
             return true;
         }
         
@@ -179,12 +247,12 @@ class SemanticAnalysis {
     bool resolveVariableDecl(VariableDecl &varDecl) {
         std::optional<Type> varType = resolveType(varDecl.type);
         if (!varType) {
-            error(varDecl.location, "variable '" + varDecl.identifier + "' has invalid type '" + varDecl.type + "'");
+            error(varDecl.location, "variable '" + varDecl.identifier.str() + "' has invalid type '" + varDecl.type.str() + "'");
             return false;
         }
         
         if (lookupDecl(varDecl.identifier)) {
-            error(varDecl.location, "variable '" + varDecl.identifier + "' redeclared");
+            error(varDecl.location, "variable '" + varDecl.identifier.str() + "' redeclared");
             return false;
         }
         
@@ -195,15 +263,15 @@ class SemanticAnalysis {
             if (!resolveExpr(*varDecl.initializer)) {
                 return false;
             }
-            Type initType = *varDecl.initializer->resolvedType;
-            if (initType != *varType) {
+            std::optional<Type> initType = varDecl.initializer->resolvedType;
+            if (!isConvertible(initType, *varType)) {
                 error(varDecl.initializer->location, "initializer type does not match variable type");
                 return false;
             }
         }
         
         // Add to current scope
-        scopes.back().emplace_back(&varDecl);
+        declare(varDecl);
         return true;
     }
 
@@ -211,7 +279,7 @@ class SemanticAnalysis {
         // Look up the target
         Decl *decl = lookupDecl(assignExpr.target);
         if (!decl) {
-            error(assignExpr.location, "assignment to undefined variable '" + assignExpr.target + "'");
+            error(assignExpr.location, "assignment to undefined variable '" + assignExpr.target.str() + "'");
             return false;
         }
         
@@ -223,10 +291,10 @@ class SemanticAnalysis {
         }
         
         // Check type compatibility
-        Type targetType = *decl->resolvedType;
-        Type valueType = *assignExpr.value->resolvedType;
+        std::optional<Type> targetType = decl->resolvedType;
+        std::optional<Type> valueType = assignExpr.value->resolvedType;
         
-        if (valueType != targetType) {
+        if (!isConvertible(valueType, targetType)) {
             error(assignExpr.value->location, "assignment type mismatch");
             return false;
         }
@@ -236,29 +304,23 @@ class SemanticAnalysis {
     }
 
     bool resolveExpr(Expr &expr) {
-        if (dynamic_cast<StringLiteral *>(&expr)) {
-            return true;  
-        }
-        if (dynamic_cast<NumberLiteral *>(&expr)) {
-            return true;
-        }
-        if (dynamic_cast<BooleanLiteral *>(&expr)) {
-            return true;  // Boolean literals already have resolvedType set
-        }
-        if (auto dre = dynamic_cast<DeclRefExpr *>(&expr)) {
-            return resolveDeclRefExpr(*dre);
-        }
-        if (auto printexpr = dynamic_cast<PrintExpr *>(&expr)) {
-            return resolvePrintExpr(*printexpr);
-        }
-        if (auto cexpr = dynamic_cast<CallExpr *>(&expr)) {
-            return resolveCallExpr(*cexpr);
-        }
-        if (auto bexpr = dynamic_cast<BinaryExpr *>(&expr)) {
-            return resolveBinaryExpr(*bexpr);
-        }
-        if (auto assignExpr = dynamic_cast<AssignmentExpr *>(&expr)) {
-            return resolveAssignmentExpr(*assignExpr);
+        switch (expr.getKind()) {
+        case NodeKind::StringLiteral:
+        case NodeKind::NumberLiteral:
+        case NodeKind::BooleanLiteral:
+            return true;  // Literals already have resolvedType set
+        case NodeKind::DeclRefExpr:
+            return resolveDeclRefExpr(llvm::cast<DeclRefExpr>(expr));
+        case NodeKind::PrintExpr:
+            return resolvePrintExpr(llvm::cast<PrintExpr>(expr));
+        case NodeKind::CallExpr:
+            return resolveCallExpr(llvm::cast<CallExpr>(expr));
+        case NodeKind::BinaryExpr:
+            return resolveBinaryExpr(llvm::cast<BinaryExpr>(expr));
+        case NodeKind::AssignmentExpr:
+            return resolveAssignmentExpr(llvm::cast<AssignmentExpr>(expr));
+        default:
+            break;
         }
         
         error(expr.location, "unknown expression type");
@@ -278,7 +340,7 @@ class SemanticAnalysis {
             }
             
             if (currentFunction && stmt->expr->resolvedType) {
-                if (*stmt->expr->resolvedType != *currentFunction->resolvedType) {
+                if (!isConvertible(stmt->expr->resolvedType, currentFunction->resolvedType)) {
                     error(stmt->location, "return type mismatch: expected " + 
                           typeToString(*currentFunction->resolvedType) + ", got " + 
                           typeToString(*stmt->expr->resolvedType));
@@ -301,16 +363,15 @@ class SemanticAnalysis {
           return false;
       }
       
-      // Condition should be an integer (boolean)
-      if (ifStmt.condition->resolvedType != Type::INT) {
+      if (!isCondition(ifStmt.condition->resolvedType)) {
           error(ifStmt.condition->location, "if condition must be an integer (boolean)");
           return false;
       }
       
       // Resolve then block
-      scopes.emplace_back();
+      pushScope();
       bool thenOk = resolveBody(*ifStmt.thenBlock);
-      scopes.pop_back();
+      popScope();
       
       if (!thenOk) {
           return false;
@@ -318,9 +379,9 @@ class SemanticAnalysis {
       
       // Resolve else block if present
       if (ifStmt.elseBlock) {
-          scopes.emplace_back();
+          pushScope();
           bool elseOk = resolveBody(*ifStmt.elseBlock);
-          scopes.pop_back();
+          popScope();
           
           if (!elseOk) {
               return false;
@@ -336,35 +397,34 @@ class SemanticAnalysis {
           return false;
       }
       
-      // Condition should be an integer (boolean)
-      if (whileStmt.condition->resolvedType != Type::INT) {
+      if (!isCondition(whileStmt.condition->resolvedType)) {
           error(whileStmt.condition->location, "while condition must be an integer (boolean)");
           return false;
       }
       
       // Resolve body
-      scopes.emplace_back();
+      pushScope();
       bool bodyOk = resolveBody(*whileStmt.body);
-      scopes.pop_back();
+      popScope();
       
       return bodyOk;
   }
   
     bool resolveStmt(Stmt &stmt) {
-        if (auto rstmt  = dynamic_cast<ReturnStmt *>(&stmt)) {
-            return resolveReturnStmt(rstmt);
-        }
-        if (auto ifStmt = dynamic_cast<IfStmt *>(&stmt)) {
-            return resolveIfStmt(*ifStmt);
-        }
-        if (auto whileStmt = dynamic_cast<WhileStmt *>(&stmt)) {
-            return resolveWhileStmt(*whileStmt);
-        }
-        if (auto varDecl = dynamic_cast<VariableDecl *>(&stmt)) {
-            return resolveVariableDecl(*varDecl);
-        }
-        if (auto expr = dynamic_cast<Expr *>(&stmt)) {
-            return resolveExpr(*expr);
+        switch (stmt.getKind()) {
+        case NodeKind::ReturnStmt:
+            return resolveReturnStmt(llvm::cast<ReturnStmt>(&stmt));
+        case NodeKind::IfStmt:
+            return resolveIfStmt(llvm::cast<IfStmt>(stmt));
+        case NodeKind::WhileStmt:
+            return resolveWhileStmt(llvm::cast<WhileStmt>(stmt));
+        case NodeKind::VariableDecl:
+            return resolveVariableDecl(llvm::cast<VariableDecl>(stmt));
+        default:
+            if (auto *expr = llvm::dyn_cast<Expr>(&stmt)) {
+                return resolveExpr(*expr);
+            }
+            break;
         }
         error(stmt.location, "unknown statement type");
         return false;
@@ -383,14 +443,14 @@ class SemanticAnalysis {
         std::optional<Type> param_type = resolveType(param.type);
         if (!param_type) {
             error(param.location, std::string{"parameter '"} +
-                  param.identifier + "' has invalid '" +
-                  param.type + "' type");
+                  param.identifier.str() + "' has invalid '" +
+                  param.type.str() + "' type");
             return false;
         }
         
         if (lookupDecl(param.identifier)) {
             error(param.location, std::string{"parameter '"} +
-                  param.identifier + "' redeclared");
+                  param.identifier.str() + "' redeclared");
             return false;
         }
         
@@ -398,10 +458,49 @@ class SemanticAnalysis {
         return true;
     }
 
+public:
+    SemanticAnalysis(std::vector<FunctionDecl *> &TopLevel,
+                     const SourceManager &SM)
+        : TopLevel(&TopLevel), SM(SM) {}
+    // For checking functions one at a time, without a whole program.
+    explicit SemanticAnalysis(const SourceManager &SM) : SM(SM) {}
+    // For checking bodies against the functions `globals` has declared,
+    // without copying them. `globals` must outlive this and declare nothing
+    // more, so that any number of these can check bodies on other threads.
+    SemanticAnalysis(const SemanticAnalysis &globals, const SourceManager &SM)
+        : SM(SM), frozenGlobals(&globals.bindings) {
+        pushScope();
+    }
+
+    // Collects diagnostics into `buffer` instead of printing them.
+    void setDiagnosticBuffer(std::vector<Diagnostic> *buffer) { diagnosticBuffer = buffer; }
+    // Records every name that was looked up in the global scope or not
+    // found at all: the names whose meaning a check depended on.
+    void setGlobalLookupLog(std::vector<Symbol> *log) { globalLookups = log; }
+
+    // Once bodies are checked, replaces constant expressions in them with
+    // literals allocated from `context` (see ConstantEvaluator). Off while
+    // `context` is null.
+    void setConstantFolding(ASTContext *context) { foldingContext = context; }
+    // Folds the given checked functions, if folding is on. Calls are only
+    // evaluated into functions whose bodies are checked and in memory.
+    void foldConstants(llvm::ArrayRef<FunctionDecl *> functions) {
+        if (!foldingContext) return;
+        ConstantEvaluator evaluator(*foldingContext);
+        for (FunctionDecl *function : functions)
+            evaluator.foldFunction(*function);
+        foldStats.folded += evaluator.getStats().folded;
+        foldStats.callsEvaluated += evaluator.getStats().callsEvaluated;
+    }
+    const ConstantEvaluator::Stats &getFoldStats() const { return foldStats; }
+
+    // Checking one function at a time, as resolve() does for a whole
+    // program: a function's signature is checked against the functions
+    // declared before it, its body against all of them.
     bool resolveFunctionSignature(FunctionDecl &function) {
         std::optional<Type> type = resolveType(function.funtype);
         if (!type) {
-            error(function.location, "invalid return type '" + function.funtype + "'");
+            error(function.location, "invalid return type '" + function.funtype.str() + "'");
             return false;
         }
         function.resolvedType = *type;
@@ -414,39 +513,44 @@ class SemanticAnalysis {
         return true;
     }
 
-public:
-    SemanticAnalysis(std::vector<std::unique_ptr<FunctionDecl>> &TopLevel)
-        : TopLevel(TopLevel) {}
+    void declareFunction(FunctionDecl &function) {
+        if (scopeStarts.empty()) pushScope();
+        declare(function);
+    }
+
+    bool resolveFunctionBody(FunctionDecl &function) {
+        currentFunction = &function;
+        if (scopeStarts.empty()) pushScope();
+        pushScope();
+        
+        // Add parameters to scope
+        for (auto &&param : function.params) {
+            declare(*param);
+        }
+        
+        // Resolve body
+        bool ok = resolveBody(*function.body);
+        popScopesTo(1);
+        return ok;
+    }
     
     bool resolve() {
-        scopes.emplace_back();
-        
         // First pass: resolve function signatures and add to scope
-        for (auto &&function : TopLevel) {
+        for (auto &&function : *TopLevel) {
             if (!resolveFunctionSignature(*function)) {
                 return false;
             }
-            scopes.back().emplace_back(function.get());
+            declareFunction(*function);
         }
         
         // Second pass: resolve function bodies
-        for (auto &&function : TopLevel) {
-            currentFunction = function.get();
-            scopes.emplace_back();
-            
-            // Add parameters to scope
-            for (auto &&param : function->params) {
-                scopes.back().emplace_back(param.get());
-            }
-            
-            // Resolve body
-            if (!resolveBody(*function->body)) {
+        for (auto &&function : *TopLevel) {
+            if (!resolveFunctionBody(*function)) {
                 return false;
             }
-            
-            scopes.pop_back();
         }
         
+        foldConstants(*TopLevel);
         return true;
     }
 };
@@ -0,0 +1,34 @@
+#ifndef SOURCEMANAGER_H
+#define SOURCEMANAGER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "utils.h"
+
+// Decoded form of a SourceLocation, for diagnostics.
+struct PresumedLoc {
+    llvm::StringRef filename;
+    unsigned line = 0;
+    unsigned col = 0;
+};
+
+// Owns every source file of a compilation and maps compact SourceLocations
+// back to files, spellings and line/column pairs.
+class SourceManager {
+    std::vector<std::unique_ptr<SourceFile>> files;  // sorted by base
+    uint64_t nextBase = 1;
+
+public:
+    // Takes ownership of `buffer` and assigns it a range of locations.
+    const SourceFile &addFile(std::string path, std::unique_ptr<llvm::MemoryBuffer> buffer);
+
+    const SourceFile *getFile(SourceLocation loc) const;
+    PresumedLoc getPresumedLoc(SourceLocation loc) const;
+    llvm::StringRef getCharacterData(SourceLocation loc, size_t length) const;
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef STREAMINGFRONTEND_H
+#define STREAMINGFRONTEND_H
+
+#include <vector>
+
+#include "llvm/ADT/STLExtras.h"
+#include "ast.h"
+#include "astcontext.h"
+#include "sourcemanager.h"
+
+// Compiles a program one function at a time, so that the memory the front
+// end holds does not grow with the number of functions.
+//
+// A first pass lexes the file on demand and parses signatures only, into
+// the caller's context; they stay alive throughout, since calls are bound
+// to them. Then each body in turn is lexed again from its own range of the
+// file, parsed into a context of its own, checked, and handed to the
+// caller to lower, after which its nodes are released and the next body
+// reuses the same memory. No token buffer is kept.
+class StreamingFrontend {
+public:
+    struct Stats {
+        size_t functions = 0;
+        size_t peakBodyMemory = 0;  // largest arena one body needed, in bytes
+        size_t constantsFolded = 0;
+    };
+
+    // Signatures are allocated from `context`, which must outlive them.
+    StreamingFrontend(const SourceManager &SM, const SourceFile &file, ASTContext &context)
+        : SM(SM), file(file), context(context) {}
+
+    // Every function in file order, without bodies.
+    std::vector<FunctionDecl *> parseSignatures();
+    // Checks every signature, then parses and checks each body in file
+    // order and passes its function to `lower`. The body is released, and
+    // FunctionDecl::body reset to null, once `lower` returns. Stops at the
+    // first error, like SemanticAnalysis::resolve.
+    bool run(llvm::function_ref<void(FunctionDecl &)> lower);
+    const Stats &getStats() const { return stats; }
+    // Folds constants in each body before it is lowered. Calls are only
+    // evaluated into the function itself, the one body in memory.
+    void setConstantFolding(bool fold) { foldConstants = fold; }
+
+private:
+    const SourceManager &SM;
+    const SourceFile &file;
+    ASTContext &context;
+    ASTContext bodyContext;
+    std::vector<FunctionDecl *> functions;
+    Stats stats;
+    bool foldConstants = false;
+
+    Block *parseBody(size_t index);
+};
+
+#endif
@@ -1,13 +1,33 @@
 #ifndef TOKEN_H
 #define TOKEN_H
 
-#include <optional>
+#include <cstdint>
 #include <string>
 #include <iostream>
 
+#include "llvm/ADT/StringRef.h"
+#include "identifiertable.h"
+#include "sourcemanager.h"
 #include "utils.h"
 
-enum class TokenKind{
+// Every reserved word of the language: token kind, spelling, and the name
+// Token::kindToString prints for it. The lexer's keyword table is generated
+// from this list, so it is the only place a keyword needs to be added.
+#define TOKEN_KEYWORDS(KEYWORD)                 \
+    KEYWORD(func,      "func",   "FUNCTION")    \
+    KEYWORD(print,     "print",  "PRINT")       \
+    KEYWORD(cf_return, "return", "RETURN")      \
+    KEYWORD(cf_int,    "int",    "INT")         \
+    KEYWORD(cf_float,  "float",  "FLOAT")       \
+    KEYWORD(cf_bool,   "bool",   "BOOL")        \
+    KEYWORD(cf_if,     "if",     "IF")          \
+    KEYWORD(cf_else,   "else",   "ELSE")        \
+    KEYWORD(cf_while,  "while",  "WHILE")       \
+    KEYWORD(cf_var,    "var",    "VAR")         \
+    KEYWORD(cf_true,   "true",   "TRUE")        \
+    KEYWORD(cf_false,  "false",  "FALSE")
+
+enum class TokenKind : uint8_t {
      eof,unk,negate,
 
      lpar,rpar,
@@ -28,22 +48,37 @@ enum class TokenKind{
      amp_amp, pipe_pipe,
 
      func,identifier, 
-     string_literal, number,print,
+     string_literal, int_literal, float_literal, print,
      
-     cf_return, cf_if, cf_else, cf_while, cf_var, cf_true, cf_false, cf_int, cf_float, cf_void,
+     cf_return, cf_if, cf_else, cf_while, cf_var, cf_true, cf_false, cf_int, cf_float, cf_bool, cf_void,
 };
 
+// Tokens do not own any text: they point back into the source buffer by
+// location and length, so building and copying one never allocates. Use
+// TokenSource::getSpelling / getStringValue to read identifiers and literals.
+// Identifiers carry their interned Symbol and number literals their
+// decoded value.
 struct Token{
-    SourceLocation location;
-    TokenKind kind;
-    std::optional<std::string> value;
+    static constexpr uint32_t maxLength = (1u << 24) - 1;
 
+    SourceLocation location;
+    uint32_t length : 24;
+    TokenKind kind : 8;
+    union {
+        Symbol symbol;       // identifier
+        int64_t intValue;    // int_literal
+        double floatValue;   // float_literal
+    };
 
-    Token(SourceLocation location, TokenKind kind, std::string value = "")
-        : location(location), kind(kind), value(value) {}
+    Token() : length(0), kind(TokenKind::eof), intValue(0) {}
+    Token(SourceLocation location, uint32_t length, TokenKind kind)
+        : location(location), length(length), kind(kind), intValue(0) {}
     
     static std::string kindToString(TokenKind kind) {
         switch(kind) {
+#define KEYWORD(kind, spelling, name) case TokenKind::kind: return name;
+            TOKEN_KEYWORDS(KEYWORD)
+#undef KEYWORD
             case TokenKind::eof: return "EOF";
             case TokenKind::lpar: return "LPAR";
             case TokenKind::rpar: return "RPAR";
@@ -52,21 +87,11 @@ struct Token{
             case TokenKind::colon: return "COLON";
             case TokenKind::semi: return "SEMI";
             case TokenKind::comma: return "COMMA";
-            case TokenKind::func: return "FUNCTION";
             case TokenKind::identifier: return "IDENTIFIER";
             case TokenKind::string_literal: return "STRING";
-            case TokenKind::number: return "NUMBER";
+            case TokenKind::int_literal: return "INT_LITERAL";
+            case TokenKind::float_literal: return "FLOAT_LITERAL";
             case TokenKind::unk: return "UNKNOWN";
-            case TokenKind::print: return "PRINT";
-            case TokenKind::cf_return: return "RETURN";
-            case TokenKind::cf_if: return "IF";
-            case TokenKind::cf_else: return "ELSE";
-            case TokenKind::cf_while: return "WHILE";
-            case TokenKind::cf_var: return "VAR";
-            case TokenKind::cf_true: return "TRUE";
-            case TokenKind::cf_false: return "FALSE";
-            case TokenKind::cf_int: return "INT";
-            case TokenKind::cf_float: return "FLOAT";
             case TokenKind::cf_void: return "VOID";
             case TokenKind::slash: return "SLASH";
             case TokenKind::percent: return "PERCENT";
@@ -92,15 +117,23 @@ struct Token{
         }
     }
     
-    void print() const {
-        std::cout << "[" << location.filepath << ":" << location.line << ":" << location.col << "] "
+    bool hasValue() const {
+        return kind == TokenKind::identifier || kind == TokenKind::int_literal ||
+               kind == TokenKind::float_literal || kind == TokenKind::string_literal;
+    }
+
+    void print(const SourceManager &SM) const {
+        auto [file, line, col] = SM.getPresumedLoc(location);
+        std::cout << "[" << file.str() << ":" << line << ":" << col << "] "
                   << kindToString(kind);
-        if (value.has_value()) {
-            std::cout << " \"" << value.value() << "\"";
+        if (hasValue()) {
+            std::cout << " \"" << SM.getCharacterData(location, length).str() << "\"";
         }
         std::cout << std::endl;
     }
 };
 
+static_assert(sizeof(Token) == 16, "tokens are stored by the million; keep them small");
+
 
 #endif
\ No newline at end of file
@@ -1,26 +1,56 @@
 #ifndef UTILS_H
 #define UTILS_H
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
-struct Dumpable{
-    void indent(size_t level){
-        for(size_t i =0;i<level;i++){
-            std::cerr << " ";
-        }
-    }
-    virtual void dump(size_t level =0) =0;
-};
+// A position in the SourceManager's 32-bit address space, in which every
+// loaded file owns a contiguous range starting at SourceFile::base. Line and
+// column are only computed when someone asks (see SourceManager).
 struct SourceLocation{
-    std::string filepath;
-    int line;
-    int col;
+    uint32_t id = 0;  // 0 is reserved for "no location"
+
+    bool isValid() const { return id != 0; }
+    SourceLocation getLocWithOffset(int32_t offset) const {
+        return SourceLocation{static_cast<uint32_t>(id + offset)};
+    }
+    bool operator==(SourceLocation other) const { return id == other.id; }
+    bool operator!=(SourceLocation other) const { return id != other.id; }
+    bool operator<(SourceLocation other) const { return id < other.id; }
 };
 
+// A loaded input file. `memory` owns the bytes (memory-mapped for regular
+// files, read in full for stdin) and must outlive every token and AST node
+// that points into it; `buffer` is the read-only view the lexer works on.
+// Files are created and owned by the SourceManager.
 struct SourceFile{
     std::string path;
-    std::string buffer;
+    std::unique_ptr<llvm::MemoryBuffer> memory;
+    llvm::StringRef buffer;
+    uint32_t base = 0;
+
+    SourceFile(std::string path, std::unique_ptr<llvm::MemoryBuffer> mem, uint32_t base)
+        : path(std::move(path)), memory(std::move(mem)),
+          buffer(memory->getBuffer()), base(base) {}
+
+    SourceLocation getLocation(size_t offset) const {
+        return SourceLocation{static_cast<uint32_t>(base + offset)};
+    }
+    size_t getOffset(SourceLocation loc) const { return loc.id - base; }
+
+    // 1-based line and column of a byte offset. The first call builds the
+    // line-start table.
+    std::pair<unsigned, unsigned> getLineAndColumn(size_t offset) const;
+
+  private:
+    mutable std::vector<uint32_t> lineStarts;
+    mutable std::once_flag lineStartsBuilt;
 };
 
 
@@ -38,12 +38,16 @@ llvm::PreservedAnalyses MyPassBBmerge::run(llvm::Function &F, llvm::FunctionAnal
             if(BI->isUnconditional()){
                 llvm::BasicBlock *succesorBB = BB.getSingleSuccessor();
                 if(succesorBB && &BB != succesorBB && &BB == succesorBB->getUniquePredecessor()){ 
+                    // BB is the only predecessor, so each phi has one value.
+                    llvm::FoldSingleEntryPHINodes(succesorBB);
                     llvm::BasicBlock::iterator InsertPos = TerminatorBB->getIterator();
                     while (!succesorBB->empty()) {
                         llvm::Instruction &Inst = succesorBB->front();
                         Inst.moveBeforePreserving(InsertPos); 
                     }
                     TerminatorBB->eraseFromParent();  
+                    // Phis in the successors now come from BB.
+                    BB.replaceSuccessorsPhiUsesWith(succesorBB, &BB);
                     blocksneed2del.push_back(succesorBB);
                     changed = true;
                     llvm::outs() << "Merged blocks: " << BB.getName() << " and " << succesorBB->getName() << "\n";
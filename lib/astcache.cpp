@@ -0,0 +1,570 @@
+#include "astcache.h"
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <tuple>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+#include "buildid.h"
+
+namespace {
+constexpr char magic[8] = {'R', 'A', 'M', 'A', 'S', 'T', '\0', '\0'};
+constexpr uint32_t byteOrderMark = 0x01020304;
+constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+constexpr uint8_t noType = 0xff;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t buildId;       // RAM_BUILD_ID of the compiler that wrote it
+    uint64_t contentHash;
+    uint64_t sourceSize;
+    uint32_t mode;
+    uint32_t numSpellings;  // identifiers and type names and string literals
+    uint32_t numNodes;
+    uint32_t numLinks;      // entries of the child lists
+    uint32_t numFunctions;
+    uint32_t spellingBytes;
+};
+
+struct Spelling {
+    uint32_t offset, length;  // in the spelling bytes
+};
+
+// One node. Which fields mean what depends on the kind:
+//   Block, PrintExpr           a, b: first link and number of statements/args
+//   ReturnStmt                 a: expression or none
+//   IfStmt                     a: condition, b: then block, c: else block or none
+//   WhileStmt                  a: condition, b: body
+//   ParamDecl                  symbol, a: type spelling
+//   FunctionDecl               symbol, a: type spelling, b, c: params, d: body
+//   VariableDecl               symbol, a: type spelling, b: initializer or none
+//   NumberLiteral              a, b: the 64 bits of the value
+//   StringLiteral              a: value spelling
+//   BooleanLiteral             flags: value
+//   DeclRefExpr                symbol, binding: resolvedDecl
+//   CallExpr                   symbol, a, b: arguments, binding: resolvedCallee
+//   BinaryExpr                 a: left, b: right, flags: operator
+//   AssignmentExpr             symbol: target, a: value, binding: resolvedTarget
+struct NodeRecord {
+    uint8_t kind;
+    uint8_t type = noType;  // resolvedType of a Decl or Expr
+    uint8_t flags = 0;
+    uint8_t pad = 0;
+    uint32_t location;      // offset in the source, or none
+    uint32_t symbol = none;
+    uint32_t binding = none;
+    uint32_t a = none, b = none, c = none, d = none;
+};
+
+// Sizes of the sections that follow the header, in file order.
+size_t imageSize(const Header &header) {
+    return sizeof(Header) + size_t(header.numSpellings) * sizeof(Spelling) +
+           size_t(header.numNodes) * sizeof(NodeRecord) +
+           size_t(header.numLinks) * sizeof(uint32_t) +
+           size_t(header.numFunctions) * sizeof(uint32_t) + header.spellingBytes;
+}
+
+class Writer : public ASTVisitor<Writer, uint32_t> {
+    const SourceFile &source;
+    llvm::StringMap<uint32_t> spellingIndex;
+    std::vector<std::pair<const ASTNode *, uint32_t>> bindings;  // resolved once all are written
+    llvm::DenseMap<const ASTNode *, uint32_t> indexOf;
+
+public:
+    std::vector<Spelling> spellings;
+    std::string spellingBytes;
+    std::vector<NodeRecord> records;
+    std::vector<uint32_t> links;
+
+    explicit Writer(const SourceFile &source) : source(source) {}
+
+    uint32_t spelling(llvm::StringRef str) {
+        auto [entry, inserted] = spellingIndex.try_emplace(str, spellings.size());
+        if (inserted) {
+            spellings.push_back({static_cast<uint32_t>(spellingBytes.size()),
+                                 static_cast<uint32_t>(str.size())});
+            spellingBytes += str;
+        }
+        return entry->second;
+    }
+
+    NodeRecord start(ASTNode &node) {
+        NodeRecord record;
+        record.kind = static_cast<uint8_t>(node.getKind());
+        record.location = node.location.isValid()
+            ? static_cast<uint32_t>(source.getOffset(node.location)) : none;
+        if (auto *decl = llvm::dyn_cast<Decl>(&node)) {
+            record.symbol = spelling(decl->identifier.getSpelling());
+            if (decl->resolvedType) record.type = static_cast<uint8_t>(*decl->resolvedType);
+        } else if (auto *expr = llvm::dyn_cast<Expr>(&node)) {
+            if (expr->resolvedType) record.type = static_cast<uint8_t>(*expr->resolvedType);
+        }
+        return record;
+    }
+
+    uint32_t finish(ASTNode &node, const NodeRecord &record, const ASTNode *binding = nullptr) {
+        uint32_t index = records.size();
+        records.push_back(record);
+        // Only declarations are bound to.
+        if (llvm::isa<Decl>(node)) indexOf[&node] = index;
+        if (binding) bindings.emplace_back(binding, index);
+        return index;
+    }
+
+    template <typename T>
+    std::pair<uint32_t, uint32_t> list(llvm::ArrayRef<T *> nodes) {
+        llvm::SmallVector<uint32_t, 16> children;
+        for (T *node : nodes) children.push_back(visit(*node));
+        uint32_t first = links.size();
+        links.insert(links.end(), children.begin(), children.end());
+        return {first, static_cast<uint32_t>(children.size())};
+    }
+
+    uint32_t optional(ASTNode *node) { return node ? visit(*node) : none; }
+
+    void resolveBindings() {
+        for (auto [target, index] : bindings) {
+            auto it = indexOf.find(target);
+            records[index].binding = it == indexOf.end() ? none : it->second;
+        }
+    }
+
+    uint32_t visitBlock(Block &node) {
+        NodeRecord record = start(node);
+        std::tie(record.a, record.b) = list(node.statements);
+        return finish(node, record);
+    }
+    uint32_t visitReturnStmt(ReturnStmt &node) {
+        NodeRecord record = start(node);
+        record.a = optional(node.expr);
+        return finish(node, record);
+    }
+    uint32_t visitIfStmt(IfStmt &node) {
+        NodeRecord record = start(node);
+        record.a = visit(*node.condition);
+        record.b = visit(*node.thenBlock);
+        record.c = optional(node.elseBlock);
+        return finish(node, record);
+    }
+    uint32_t visitWhileStmt(WhileStmt &node) {
+        NodeRecord record = start(node);
+        record.a = visit(*node.condition);
+        record.b = visit(*node.body);
+        return finish(node, record);
+    }
+    uint32_t visitParamDecl(ParamDecl &node) {
+        NodeRecord record = start(node);
+        record.a = spelling(node.type);
+        return finish(node, record);
+    }
+    uint32_t visitFunctionDecl(FunctionDecl &node) {
+        NodeRecord record = start(node);
+        record.a = spelling(node.funtype);
+        std::tie(record.b, record.c) = list(node.params);
+        record.d = optional(node.body);
+        return finish(node, record);
+    }
+    uint32_t visitVariableDecl(VariableDecl &node) {
+        NodeRecord record = start(node);
+        record.a = spelling(node.type);
+        record.b = optional(node.initializer);
+        return finish(node, record);
+    }
+    uint32_t visitPrintExpr(PrintExpr &node) {
+        NodeRecord record = start(node);
+        std::tie(record.a, record.b) = list(node.args);
+        return finish(node, record);
+    }
+    uint32_t visitNumberLiteral(NumberLiteral &node) {
+        NodeRecord record = start(node);
+        uint64_t bits;
+        std::memcpy(&bits, &node.intValue, sizeof(bits));
+        record.a = static_cast<uint32_t>(bits);
+        record.b = static_cast<uint32_t>(bits >> 32);
+        return finish(node, record);
+    }
+    uint32_t visitStringLiteral(StringLiteral &node) {
+        NodeRecord record = start(node);
+        record.a = spelling(node.value);
+        return finish(node, record);
+    }
+    uint32_t visitBooleanLiteral(BooleanLiteral &node) {
+        NodeRecord record = start(node);
+        record.flags = node.value;
+        return finish(node, record);
+    }
+    uint32_t visitDeclRefExpr(DeclRefExpr &node) {
+        NodeRecord record = start(node);
+        record.symbol = spelling(node.identifier.getSpelling());
+        return finish(node, record, node.resolvedDecl);
+    }
+    uint32_t visitCallExpr(CallExpr &node) {
+        NodeRecord record = start(node);
+        record.symbol = spelling(node.identifier.getSpelling());
+        std::tie(record.a, record.b) = list(node.arguments);
+        return finish(node, record, node.resolvedCallee);
+    }
+    uint32_t visitBinaryExpr(BinaryExpr &node) {
+        NodeRecord record = start(node);
+        record.a = visit(*node.left);
+        record.b = visit(*node.right);
+        record.flags = static_cast<uint8_t>(node.op);
+        return finish(node, record);
+    }
+    uint32_t visitAssignmentExpr(AssignmentExpr &node) {
+        NodeRecord record = start(node);
+        record.symbol = spelling(node.target.getSpelling());
+        record.a = visit(*node.value);
+        return finish(node, record, node.resolvedTarget);
+    }
+};
+
+// Builds the nodes of a cache image. Every index read from the file is
+// checked before use, so a damaged cache is rejected, not followed.
+class Reader {
+    const char *image;
+    const Header &header;
+    const SourceFile &source;
+    ASTContext &context;
+    const char *spellingTable, *recordTable, *linkTable, *functionTable, *spellingBytes;
+    std::vector<Symbol> symbols;          // interned on first use
+    std::vector<llvm::StringRef> strings;  // copied into the context on first use
+    std::vector<ASTNode *> nodes;
+    bool ok = true;
+
+    template <typename T>
+    T read(const char *table, size_t index) const {
+        T value;
+        std::memcpy(&value, table + index * sizeof(T), sizeof(T));
+        return value;
+    }
+
+    Spelling spellingAt(uint32_t index) {
+        if (index >= header.numSpellings) {
+            ok = false;
+            return {0, 0};
+        }
+        Spelling spelling = read<Spelling>(spellingTable, index);
+        if (spelling.offset > header.spellingBytes ||
+            spelling.length > header.spellingBytes - spelling.offset) {
+            ok = false;
+            return {0, 0};
+        }
+        return spelling;
+    }
+    Symbol symbol(uint32_t index) {
+        Spelling spelling = spellingAt(index);
+        if (!ok) return {};
+        if (!symbols[index].isValid())
+            symbols[index] = IdentifierTable::global().intern(
+                llvm::StringRef(spellingBytes + spelling.offset, spelling.length));
+        return symbols[index];
+    }
+    llvm::StringRef string(uint32_t index) {
+        Spelling spelling = spellingAt(index);
+        if (!ok) return {};
+        if (strings[index].data() == nullptr)
+            strings[index] = spelling.length
+                ? context.copyString(llvm::StringRef(spellingBytes + spelling.offset, spelling.length))
+                : llvm::StringRef("", 0);
+        return strings[index];
+    }
+
+    // Node `index`, built before the one at `before`, if it is a T.
+    template <typename T>
+    T *child(uint32_t index, size_t before) {
+        if (index >= before) {
+            ok = false;
+            return nullptr;
+        }
+        T *node = llvm::dyn_cast<T>(nodes[index]);
+        if (!node) ok = false;
+        return node;
+    }
+    template <typename T>
+    T *optionalChild(uint32_t index, size_t before) {
+        return index == none ? nullptr : child<T>(index, before);
+    }
+    template <typename T>
+    llvm::MutableArrayRef<T *> children(uint32_t first, uint32_t count, size_t before) {
+        if (first > header.numLinks || count > header.numLinks - first) {
+            ok = false;
+            return {};
+        }
+        llvm::SmallVector<T *, 16> list;
+        for (uint32_t i = 0; i < count; ++i)
+            list.push_back(child<T>(read<uint32_t>(linkTable, first + i), before));
+        return context.copyArray<T *>(list);
+    }
+
+    // The operator of a BinaryExpr, if it is one the parser gives a
+    // precedence to.
+    TokenKind binaryOperator(uint8_t flags) {
+        auto op = static_cast<TokenKind>(flags);
+        switch (op) {
+        case TokenKind::plus:
+        case TokenKind::minus:
+        case TokenKind::mul:
+        case TokenKind::slash:
+        case TokenKind::percent:
+        case TokenKind::lessthan:
+        case TokenKind::greaterthan:
+        case TokenKind::less_equal:
+        case TokenKind::great_equal:
+        case TokenKind::doublequal:
+        case TokenKind::not_equal:
+        case TokenKind::amp_amp:
+        case TokenKind::pipe_pipe:
+            return op;
+        default:
+            ok = false;
+            return TokenKind::unk;
+        }
+    }
+
+    ASTNode *build(const NodeRecord &record, size_t index) {
+        SourceLocation location;
+        if (record.location != none) {
+            if (record.location > header.sourceSize) {
+                ok = false;
+                return nullptr;
+            }
+            location = source.getLocation(record.location);
+        }
+        switch (static_cast<NodeKind>(record.kind)) {
+        case NodeKind::Block:
+            return context.create<Block>(location, children<Stmt>(record.a, record.b, index));
+        case NodeKind::ReturnStmt:
+            return context.create<ReturnStmt>(location, optionalChild<Expr>(record.a, index));
+        case NodeKind::IfStmt:
+            return context.create<IfStmt>(location, child<Expr>(record.a, index),
+                                          child<Block>(record.b, index),
+                                          optionalChild<Block>(record.c, index));
+        case NodeKind::WhileStmt:
+            return context.create<WhileStmt>(location, child<Expr>(record.a, index),
+                                             child<Block>(record.b, index));
+        case NodeKind::ParamDecl:
+            return context.create<ParamDecl>(location, symbol(record.symbol), string(record.a));
+        case NodeKind::FunctionDecl:
+            return context.create<FunctionDecl>(location, symbol(record.symbol), string(record.a),
+                                                children<ParamDecl>(record.b, record.c, index),
+                                                optionalChild<Block>(record.d, index));
+        case NodeKind::VariableDecl:
+            return context.create<VariableDecl>(location, symbol(record.symbol), string(record.a),
+                                                optionalChild<Expr>(record.b, index));
+        case NodeKind::PrintExpr:
+            return context.create<PrintExpr>(location, children<Expr>(record.a, record.b, index));
+        case NodeKind::NumberLiteral: {
+            uint64_t bits = uint64_t(record.b) << 32 | record.a;
+            int64_t value;
+            std::memcpy(&value, &bits, sizeof(value));
+            // The record's type says which member the bits belong to.
+            return context.create<NumberLiteral>(location, value);
+        }
+        case NodeKind::StringLiteral:
+            return context.create<StringLiteral>(location, string(record.a));
+        case NodeKind::BooleanLiteral:
+            return context.create<BooleanLiteral>(location, record.flags != 0);
+        case NodeKind::DeclRefExpr:
+            return context.create<DeclRefExpr>(location, symbol(record.symbol));
+        case NodeKind::CallExpr:
+            return context.create<CallExpr>(location, symbol(record.symbol),
+                                            children<Expr>(record.a, record.b, index));
+        case NodeKind::BinaryExpr:
+            return context.create<BinaryExpr>(location, child<Expr>(record.a, index),
+                                              binaryOperator(record.flags),
+                                              child<Expr>(record.b, index));
+        case NodeKind::AssignmentExpr:
+            return context.create<AssignmentExpr>(location, symbol(record.symbol),
+                                                  child<Expr>(record.a, index));
+        }
+        ok = false;
+        return nullptr;
+    }
+
+    bool setType(ASTNode *node, uint8_t type) {
+        std::optional<Type> resolved;
+        if (type != noType) {
+            if (type > static_cast<uint8_t>(Type::BOOL)) return false;
+            resolved = static_cast<Type>(type);
+        }
+        if (auto *decl = llvm::dyn_cast<Decl>(node))
+            decl->resolvedType = resolved;
+        else if (auto *expr = llvm::dyn_cast<Expr>(node))
+            expr->resolvedType = resolved;
+        return true;
+    }
+
+    template <typename T>
+    T *bound(uint32_t index) {
+        if (index == none) return nullptr;
+        if (index >= nodes.size()) {
+            ok = false;
+            return nullptr;
+        }
+        T *node = llvm::dyn_cast<T>(nodes[index]);
+        if (!node) ok = false;
+        return node;
+    }
+
+public:
+    Reader(const char *image, const Header &header, const SourceFile &source, ASTContext &context)
+        : image(image), header(header), source(source), context(context),
+          symbols(header.numSpellings), strings(header.numSpellings) {
+        spellingTable = image + sizeof(Header);
+        recordTable = spellingTable + size_t(header.numSpellings) * sizeof(Spelling);
+        linkTable = recordTable + size_t(header.numNodes) * sizeof(NodeRecord);
+        functionTable = linkTable + size_t(header.numLinks) * sizeof(uint32_t);
+        spellingBytes = functionTable + size_t(header.numFunctions) * sizeof(uint32_t);
+    }
+
+    bool run(std::vector<FunctionDecl *> &program) {
+        nodes.reserve(header.numNodes);
+        for (size_t i = 0; i < header.numNodes && ok; ++i) {
+            NodeRecord record = read<NodeRecord>(recordTable, i);
+            ASTNode *node = build(record, i);
+            if (!ok || !setType(node, record.type)) return false;
+            nodes.push_back(node);
+        }
+        if (!ok) return false;
+
+        for (size_t i = 0; i < header.numNodes && ok; ++i) {
+            NodeRecord record = read<NodeRecord>(recordTable, i);
+            switch (nodes[i]->getKind()) {
+            case NodeKind::DeclRefExpr:
+                llvm::cast<DeclRefExpr>(nodes[i])->resolvedDecl = bound<Decl>(record.binding);
+                break;
+            case NodeKind::CallExpr:
+                llvm::cast<CallExpr>(nodes[i])->resolvedCallee = bound<FunctionDecl>(record.binding);
+                break;
+            case NodeKind::AssignmentExpr:
+                llvm::cast<AssignmentExpr>(nodes[i])->resolvedTarget = bound<Decl>(record.binding);
+                break;
+            default:
+                break;
+            }
+        }
+
+        for (size_t i = 0; i < header.numFunctions && ok; ++i)
+            program.push_back(bound<FunctionDecl>(read<uint32_t>(functionTable, i)));
+        return ok;
+    }
+};
+}
+
+ASTCache::ASTCache(std::string path, const SourceFile &source, uint32_t mode)
+    : path(std::move(path)), source(source), mode(mode),
+      contentHash(llvm::xxHash64(source.buffer)) {}
+
+const char *ASTCache::getStatusName(Status status) {
+    switch (status) {
+    case Status::NotLoaded: return "not loaded";
+    case Status::Hit: return "hit";
+    case Status::Missing: return "miss (no cache)";
+    case Status::Stale: return "miss (source, mode or compiler changed)";
+    case Status::Invalid: return "miss (damaged cache)";
+    }
+    return "unknown";
+}
+
+bool ASTCache::load(ASTContext &context, std::vector<FunctionDecl *> &program) {
+    auto bufferOrErr = llvm::MemoryBuffer::getFile(path, /*IsText=*/false,
+                                                   /*RequiresNullTerminator=*/false);
+    if (!bufferOrErr) {
+        status = Status::Missing;
+        return false;
+    }
+    llvm::StringRef image = (*bufferOrErr)->getBuffer();
+    fileSize = image.size();
+
+    Header header;
+    if (image.size() < sizeof(Header)) {
+        status = Status::Invalid;
+        return false;
+    }
+    std::memcpy(&header, image.data(), sizeof(Header));
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.byteOrder != byteOrderMark) {
+        status = Status::Invalid;
+        return false;
+    }
+    if (header.version != formatVersion || header.buildId != RAM_BUILD_ID ||
+        header.mode != mode || header.contentHash != contentHash ||
+        header.sourceSize != source.buffer.size()) {
+        status = Status::Stale;
+        return false;
+    }
+    if (imageSize(header) != image.size()) {
+        status = Status::Invalid;
+        return false;
+    }
+
+    std::vector<FunctionDecl *> functions;
+    if (!Reader(image.data(), header, source, context).run(functions)) {
+        status = Status::Invalid;
+        return false;
+    }
+    program = std::move(functions);
+    numNodes = header.numNodes;
+    status = Status::Hit;
+    return true;
+}
+
+bool ASTCache::store(llvm::ArrayRef<FunctionDecl *> program) {
+    Writer writer(source);
+    std::vector<uint32_t> functions;
+    for (FunctionDecl *function : program) functions.push_back(writer.visit(*function));
+    writer.resolveBindings();
+
+    Header header;
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = formatVersion;
+    header.byteOrder = byteOrderMark;
+    header.buildId = RAM_BUILD_ID;
+    header.contentHash = contentHash;
+    header.sourceSize = source.buffer.size();
+    header.mode = mode;
+    header.numSpellings = writer.spellings.size();
+    header.numNodes = writer.records.size();
+    header.numLinks = writer.links.size();
+    header.numFunctions = functions.size();
+    header.spellingBytes = writer.spellingBytes.size();
+
+    // Written under another name and renamed, so that a reader never sees
+    // half a file.
+    std::string tempPath = path + ".tmp";
+    {
+        std::error_code EC;
+        llvm::raw_fd_ostream out(tempPath, EC, llvm::sys::fs::OF_None);
+        if (EC) return false;
+        auto write = [&out](const void *data, size_t size) {
+            out.write(static_cast<const char *>(data), size);
+        };
+        write(&header, sizeof(header));
+        write(writer.spellings.data(), writer.spellings.size() * sizeof(Spelling));
+        write(writer.records.data(), writer.records.size() * sizeof(NodeRecord));
+        write(writer.links.data(), writer.links.size() * sizeof(uint32_t));
+        write(functions.data(), functions.size() * sizeof(uint32_t));
+        write(writer.spellingBytes.data(), writer.spellingBytes.size());
+        out.close();
+        if (out.has_error()) {
+            out.clear_error();
+            llvm::sys::fs::remove(tempPath);
+            return false;
+        }
+    }
+    if (llvm::sys::fs::rename(tempPath, path)) {
+        llvm::sys::fs::remove(tempPath);
+        return false;
+    }
+    fileSize = imageSize(header);
+    numNodes = header.numNodes;
+    return true;
+}
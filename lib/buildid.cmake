@@ -0,0 +1,26 @@
+# Writes OUTPUT, a header defining RAM_BUILD_ID: a hash of the compiler's
+# sources under SOURCE_DIR and of CONFIG, which says how they are built.
+# The header is only rewritten when the hash changes, so that rebuilding
+# unchanged sources does not recompile what includes it.
+#
+#   cmake -DSOURCE_DIR=<dir> -DOUTPUT=<header> -DCONFIG=<text> -P buildid.cmake
+
+file(GLOB sources ${SOURCE_DIR}/lib/*.cpp ${SOURCE_DIR}/include/*.h)
+list(SORT sources)
+set(hashes "${CONFIG}")
+foreach(source ${sources})
+    file(SHA256 ${source} hash)
+    string(APPEND hashes "\n${hash}")
+endforeach()
+string(SHA256 id "${hashes}")
+string(SUBSTRING ${id} 0 16 id)
+
+string(CONCAT text "// Generated by lib/buildid.cmake: identifies this build of the compiler.\n"
+                   "#define RAM_BUILD_ID 0x${id}ull\n")
+set(old "")
+if(EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} old)
+endif()
+if(NOT old STREQUAL text)
+    file(WRITE ${OUTPUT} "${text}")
+endif()
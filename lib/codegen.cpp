@@ -1,8 +1,9 @@
 
 #include "llvm/IR/Verifier.h"
+#include "llvm/IR/CFG.h"
 #include "llvm/ADT/APFloat.h"
 #include "llvm/Transforms/Scalar/GVN.h"
-#include "llvm/Transforms/Utils/Mem2Reg.h"
+#include "llvm/Transforms/IPO/GlobalDCE.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/FileSystem.h"
 #include <system_error> 
@@ -23,18 +24,94 @@
 #include "MyPassBBmerge.h"
 #include "SEPass.h"
 
-Codegen::Codegen(){
+namespace {
+llvm::OptimizationLevel getPassBuilderLevel(Codegen::OptLevel level) {
+  switch (level) {
+  case Codegen::OptLevel::Default: return llvm::OptimizationLevel::O0;
+  case Codegen::OptLevel::O0: return llvm::OptimizationLevel::O0;
+  case Codegen::OptLevel::O1: return llvm::OptimizationLevel::O1;
+  case Codegen::OptLevel::O2: return llvm::OptimizationLevel::O2;
+  case Codegen::OptLevel::O3: return llvm::OptimizationLevel::O3;
+  case Codegen::OptLevel::Os: return llvm::OptimizationLevel::Os;
+  }
+  return llvm::OptimizationLevel::O0;
+}
+
+llvm::CodeGenOptLevel getCodeGenLevel(Codegen::OptLevel level) {
+  switch (level) {
+  case Codegen::OptLevel::Default: return llvm::CodeGenOptLevel::Default;
+  case Codegen::OptLevel::O0: return llvm::CodeGenOptLevel::None;
+  case Codegen::OptLevel::O1: return llvm::CodeGenOptLevel::Less;
+  case Codegen::OptLevel::O2: return llvm::CodeGenOptLevel::Default;
+  case Codegen::OptLevel::O3: return llvm::CodeGenOptLevel::Aggressive;
+  case Codegen::OptLevel::Os: return llvm::CodeGenOptLevel::Default;
+  }
+  return llvm::CodeGenOptLevel::Default;
+}
+}
+
+Codegen::Codegen(OptLevel level){
     TheContext = std::make_unique<llvm::LLVMContext>();
     TheModule = std::make_unique<llvm::Module>("ram-compiler", *TheContext);
     Builder = std::make_unique<llvm::IRBuilder<>>(*TheContext);
-    
-    TheFPM = std::make_unique<llvm::FunctionPassManager>();
+
+    // Initialize all targets
+    llvm::InitializeAllTargetInfos();
+    llvm::InitializeAllTargets();
+    llvm::InitializeAllTargetMCs();
+    llvm::InitializeAllAsmParsers();
+    llvm::InitializeAllAsmPrinters();
+
+    // Get the target triple
+    auto targetTripleStr = llvm::sys::getDefaultTargetTriple();
+    llvm::Triple targetTriple(targetTripleStr);
+    TheModule->setTargetTriple(targetTriple);
+
+    // Look up the target. The target machine is made up front, so that the
+    // optimization pipeline sees the data layout and costs of the target.
+    std::string error;
+    auto target = llvm::TargetRegistry::lookupTarget(targetTripleStr, error);
+    if (!target) {
+        llvm::errs() << error << "\n";
+    } else {
+        auto CPU = "generic";
+        auto features = "";
+        llvm::TargetOptions opt;
+        std::optional<llvm::Reloc::Model> RM;
+        std::optional<llvm::CodeModel::Model> CM;
+        TheTargetMachine.reset(target->createTargetMachine(targetTriple, CPU, features, opt, RM, CM,
+                                                           getCodeGenLevel(level)));
+    }
+    if (TheTargetMachine)
+        TheModule->setDataLayout(TheTargetMachine->createDataLayout());
+
     TheLAM = std::make_unique<llvm::LoopAnalysisManager>();
     TheFAM = std::make_unique<llvm::FunctionAnalysisManager>();
     TheCGAM = std::make_unique<llvm::CGSCCAnalysisManager>();
     TheMAM = std::make_unique<llvm::ModuleAnalysisManager>();
 
-    llvm::PassBuilder PB;
+    llvm::PassBuilder PB(TheTargetMachine.get());
+    // Our own passes go where the default pipelines have room for them:
+    // dead code removal after each round of peephole simplification, and
+    // constant branch folding and block merging at the end of the function
+    // simplification passes. -O0 has no peephole round, so both run at
+    // the end there. SEPass stays off: InstCombine already turns
+    // multiplications by a power of two into shifts.
+    PB.registerPeepholeEPCallback([](llvm::FunctionPassManager &FPM, llvm::OptimizationLevel) {
+        FPM.addPass(MyPass());
+    });
+    PB.registerScalarOptimizerLateEPCallback(
+        [](llvm::FunctionPassManager &FPM, llvm::OptimizationLevel passLevel) {
+            if (passLevel == llvm::OptimizationLevel::O0)
+                FPM.addPass(MyPass());
+            FPM.addPass(MyPassBBmerge());
+        });
+    // Functions left unreachable from main once optimize() has made the
+    // others internal are dropped before anything is spent on them.
+    PB.registerPipelineStartEPCallback([](llvm::ModulePassManager &MPM, llvm::OptimizationLevel) {
+        MPM.addPass(llvm::GlobalDCEPass());
+    });
+
     PB.registerLoopAnalyses(*TheLAM);
     PB.registerFunctionAnalyses(*TheFAM);
     PB.registerCGSCCAnalyses(*TheCGAM);
@@ -42,49 +119,34 @@ Codegen::Codegen(){
 
     PB.crossRegisterProxies(*TheLAM, *TheFAM, *TheCGAM, *TheMAM);
 
-    TheFPM->addPass(llvm::PromotePass()); 
-
-    // TheFPM->addPass(llvm::GVNPass());  
-    TheFPM->addPass(MyPass()); 
-    TheFPM->addPass(MyPassBBmerge());
-//     TheFPM->addPass(SEPass());
+    llvm::OptimizationLevel passLevel = getPassBuilderLevel(level);
+    TheMPM = std::make_unique<llvm::ModulePassManager>(
+        passLevel == llvm::OptimizationLevel::O0 ? PB.buildO0DefaultPipeline(passLevel)
+                                                 : PB.buildPerModuleDefaultPipeline(passLevel));
+}
 
+// main is the only entry point of a program, so every other function is
+// made internal first: then the pipeline sees all of its callers. At -O1
+// and up, the CGSCC inliner folds helpers into them, IPSCCP propagates
+// constants that every call passes, and GlobalDCE removes what is left
+// unused; at -O0, only the last. A module without a main keeps every
+// function visible.
+void Codegen::optimize() {
+    llvm::Function *main = TheModule->getFunction("main");
+    if (main && !main->isDeclaration()) {
+        for (llvm::Function &function : *TheModule)
+            if (&function != main && !function.isDeclaration())
+                function.setLinkage(llvm::GlobalValue::InternalLinkage);
+    }
+    TheMPM->run(*TheModule, *TheMAM);
 }
-bool Codegen::GenerateObjectFile(std::string filename) {
-  // Initialize all targets
-  llvm::InitializeAllTargetInfos();
-  llvm::InitializeAllTargets();
-  llvm::InitializeAllTargetMCs();
-  llvm::InitializeAllAsmParsers();
-  llvm::InitializeAllAsmPrinters();
-
-  // Get the target triple
-  auto targetTripleStr = llvm::sys::getDefaultTargetTriple();
-llvm::Triple targetTriple(targetTripleStr);
-  TheModule->setTargetTriple(targetTriple);
-
-  // Look up the target
-  std::string error;
-  auto target = llvm::TargetRegistry::lookupTarget(targetTripleStr, error);
-  if (!target) {
-    llvm::errs() << error << "\n";
-    return false;
-  }
 
-  // Create target machine
-  auto CPU = "generic";
-  auto features = "";
-  llvm::TargetOptions opt;
-  std::optional<llvm::Reloc::Model> RM;
-  auto targetMachine = target->createTargetMachine(targetTriple, CPU, features, opt, RM);
-  if (!targetMachine) {
+bool Codegen::GenerateObjectFile(std::string filename) {
+  if (!TheTargetMachine) {
     llvm::errs() << "Failed to create target machine\n";
     return false;
   }
 
-  // Configure module for target
-  TheModule->setDataLayout(targetMachine->createDataLayout());
-
   // Open output file
   std::error_code EC;
   llvm::raw_fd_ostream dest(filename, EC, llvm::sys::fs::OF_None);
@@ -97,7 +159,7 @@ llvm::Triple targetTriple(targetTripleStr);
   llvm::legacy::PassManager pass;
   auto fileType = llvm::CodeGenFileType::ObjectFile;
 
-  if (targetMachine->addPassesToEmitFile(pass, dest, nullptr, fileType)) {
+  if (TheTargetMachine->addPassesToEmitFile(pass, dest, nullptr, fileType)) {
     llvm::errs() << "Target machine can't emit a file of this type\n";
     return false;
   }
@@ -113,11 +175,19 @@ void logerror(const char* str){
     std::cerr <<"Codegen error"<<str<<std::endl;
 }
 
-void Codegen::generate(std::vector<std::unique_ptr<FunctionDecl>> & functions){
+void Codegen::generate(std::vector<FunctionDecl *> & functions){
+       for(auto &func : functions){
+        declareFunction(*func);
+       }
        for(auto &func : functions){
-        func->accept(*this);
+        visitFunctionDecl(*func);
        }
-       std::error_code EC;
+       optimize();
+       writeIR();
+}
+
+void Codegen::writeIR(){
+    std::error_code EC;
     llvm::raw_fd_ostream OS("Output.ll", EC, llvm::sys::fs::OF_None);
     if (EC) {
         llvm::errs() << "Error opening file: " << EC.message() << "\n";
@@ -131,72 +201,171 @@ void Codegen::generate(std::vector<std::unique_ptr<FunctionDecl>> & functions){
 
 }
 
-void Codegen::visit(FunctionDecl& node){
+llvm::Type *Codegen::variableType(const Decl &variable) {
+    if (auto *param = llvm::dyn_cast<ParamDecl>(&variable))
+        return GenerateType(param->type);
+    return GenerateType(llvm::cast<VariableDecl>(variable).type);
+}
+
+void Codegen::writeVariable(const Decl &variable, llvm::BasicBlock *block, llvm::Value *value) {
+    currentDef[block][&variable] = value;
+}
+
+llvm::Value *Codegen::readVariable(const Decl &variable, llvm::BasicBlock *block) {
+    auto blockDefs = currentDef.find(block);
+    if (blockDefs != currentDef.end()) {
+        auto def = blockDefs->second.find(&variable);
+        if (def != blockDefs->second.end() && def->second)
+            return def->second;
+    }
+    return readVariableRecursive(variable, block);
+}
+
+llvm::Value *Codegen::readVariableRecursive(const Decl &variable, llvm::BasicBlock *block) {
+    llvm::Value *value;
+    if (!sealedBlocks.count(block)) {
+        // Not all predecessors are known yet.
+        llvm::IRBuilder<> phiBuilder(block, block->begin());
+        llvm::PHINode *phi = phiBuilder.CreatePHI(variableType(variable), 0,
+                                                  variable.identifier.getSpelling());
+        incompletePhis[block].emplace_back(&variable, phi);
+        value = phi;
+    } else if (llvm::BasicBlock *pred = block->getSinglePredecessor()) {
+        value = readVariable(variable, pred);
+    } else if (llvm::pred_empty(block)) {
+        // Read before any assignment.
+        value = llvm::UndefValue::get(variableType(variable));
+    } else {
+        // The phi is recorded first, so that a loop back to this block
+        // reads it instead of coming round again.
+        llvm::IRBuilder<> phiBuilder(block, block->begin());
+        llvm::PHINode *phi = phiBuilder.CreatePHI(variableType(variable), 0,
+                                                  variable.identifier.getSpelling());
+        writeVariable(variable, block, phi);
+        value = addPhiOperands(variable, phi);
+    }
+    writeVariable(variable, block, value);
+    return value;
+}
+
+llvm::Value *Codegen::addPhiOperands(const Decl &variable, llvm::PHINode *phi) {
+    for (llvm::BasicBlock *pred : llvm::predecessors(phi->getParent()))
+        phi->addIncoming(readVariable(variable, pred), pred);
+    return tryRemoveTrivialPhi(phi);
+}
+
+// A phi that merges a single value (besides itself) is replaced by that
+// value, which may make the phis using it trivial in turn.
+llvm::Value *Codegen::tryRemoveTrivialPhi(llvm::PHINode *phi) {
+    llvm::Value *same = nullptr;
+    for (llvm::Value *op : phi->incoming_values()) {
+        if (op == same || op == phi) continue;
+        if (same) return phi;
+        same = op;
+    }
+    if (!same) same = llvm::UndefValue::get(phi->getType());
+
+    llvm::SmallVector<llvm::WeakVH, 4> phiUsers;
+    for (llvm::User *user : phi->users())
+        if (user != phi && llvm::isa<llvm::PHINode>(user)) phiUsers.emplace_back(user);
+    phi->replaceAllUsesWith(same);
+    phi->eraseFromParent();
+    for (llvm::WeakVH &user : phiUsers)
+        if (auto *userPhi = llvm::dyn_cast_or_null<llvm::PHINode>(user))
+            tryRemoveTrivialPhi(userPhi);
+    return same;
+}
+
+void Codegen::sealBlock(llvm::BasicBlock *block) {
+    auto incomplete = incompletePhis.find(block);
+    if (incomplete != incompletePhis.end()) {
+        auto phis = std::move(incomplete->second);
+        incompletePhis.erase(incomplete);
+        for (auto &[variable, phi] : phis)
+            addPhiOperands(*variable, phi);
+    }
+    sealedBlocks.insert(block);
+}
+
+void Codegen::clearVariables() {
+    currentDef.clear();
+    incompletePhis.clear();
+    sealedBlocks.clear();
+}
+
+llvm::Function *Codegen::declareFunction(const FunctionDecl &node) {
+    llvm::Function *&function = functions[&node];
+    if (function)
+        return function;
     std::vector<llvm::Type *> paramTypes;
-    llvm::Type* funtype=GenerateType(node.funtype);
-    
     for (auto &&param : node.params)
       paramTypes.emplace_back(GenerateType(param->type));
-    
-    llvm::FunctionType* functype = llvm::FunctionType::get(funtype,paramTypes,false);
-    auto function= llvm::Function::Create(functype,llvm::Function::ExternalLinkage, node.identifier,*TheModule);
-    
+
+    // A void main still gives the C runtime an exit status: 0.
+    llvm::Type *returnType = GenerateType(node.funtype);
+    if (returnType->isVoidTy() && node.identifier.getSpelling() == "main")
+        returnType = llvm::Type::getInt32Ty(*TheContext);
+    llvm::FunctionType* functype = llvm::FunctionType::get(returnType,paramTypes,false);
+    function = llvm::Function::Create(functype,llvm::Function::ExternalLinkage, node.identifier.getSpelling(),*TheModule);
+    int idx=0;
+    for(auto &&args :function->args()){
+     args.setName(node.params[idx]->identifier.getSpelling());
+     ++idx;
+    }
+    return function;
+}
+
+llvm::Value *Codegen::visitFunctionDecl(FunctionDecl &node) {
+    llvm::Function* function = declareFunction(node);
+    llvm::Type* funtype = function->getReturnType();
+
     llvm::BasicBlock* entry = llvm::BasicBlock::Create(*TheContext, "", function);
     Builder->SetInsertPoint(entry);
+    clearVariables();
+    sealBlock(entry);
 
     int idx=0;
-    NamedValues.clear();
     for(auto &&args :function->args()){
-     args.setName(node.params[idx]->identifier);
-     NamedValues[node.params[idx]->identifier] = &args;
+     writeVariable(*node.params[idx], entry, &args);
      ++idx;
     }
-    node.body->accept(*this);
-    if (funtype->isVoidTy() && !Builder->GetInsertBlock()->getTerminator()) {
-        Builder->CreateRetVoid(); 
+    visitBlock(*node.body);
+    if (node.resolvedType == Type::VOID && !Builder->GetInsertBlock()->getTerminator()) {
+        emitVoidReturn(funtype);
     }
     llvm::verifyFunction(*function);
-    TheFPM->run(*function,*TheFAM);
+    return nullptr;
 }
 
-void Codegen::visit(Block& node){
+llvm::Value *Codegen::visitBlock(Block &node) {
      for(auto &stmt : node.statements){
-        stmt->accept(*this);
+        visit(*stmt);
      }
+     return nullptr;
 }
 
-void Codegen::visit(DeclRefExpr& node){
-     llvm::Value *value= NamedValues[node.identifier];
-     if(!value){
+llvm::Value *Codegen::visitDeclRefExpr(DeclRefExpr &node) {
+     if(!llvm::isa_and_nonnull<VariableDecl, ParamDecl>(node.resolvedDecl)){
         logerror("Unknown variable name identified");
-        lastValue=nullptr;
-        return;
-     }
-     if (llvm::isa<llvm::AllocaInst>(value)) {
-         lastValue = Builder->CreateLoad(
-             llvm::cast<llvm::AllocaInst>(value)->getAllocatedType(),
-             value,
-             node.identifier
-         );
-     } else {
-         lastValue = value;
+        return nullptr;
      }
+     return readVariable(*node.resolvedDecl, Builder->GetInsertBlock());
 }
 
-void Codegen::visit(ReturnStmt& node) {
+llvm::Value *Codegen::visitReturnStmt(ReturnStmt &node) {
     llvm::Function* currentFunc = Builder->GetInsertBlock()->getParent();
     llvm::Type* returnType = currentFunc->getReturnType();
 
     if(node.expr){
-        node.expr->accept(*this);
-        if(lastValue){
-            // Cast to return type if needed
-            if (lastValue->getType() != returnType) {
+        llvm::Value *value = visit(*node.expr);
+        if(value){
+            value = convert(value, returnType);
+            if (value->getType() != returnType) {
                 logerror("Return type mismatch");
                 Builder->CreateRet(llvm::UndefValue::get(returnType));
-                return;
+                return nullptr;
             }
-            Builder->CreateRet(lastValue);
+            Builder->CreateRet(value);
         }
         else {
             // Error handling or default?
@@ -213,23 +382,33 @@ void Codegen::visit(ReturnStmt& node) {
         }
     }
     else{
-        Builder->CreateRetVoid(); 
+        emitVoidReturn(returnType);
     }
+    return nullptr;
+}
+
+void Codegen::emitVoidReturn(llvm::Type *returnType) {
+    if (returnType->isVoidTy())
+        Builder->CreateRetVoid();
+    else
+        Builder->CreateRet(llvm::ConstantInt::get(returnType, 0));  // main
 }
 
 
-void Codegen::visit(PrintExpr& node){
+llvm::Value *Codegen::visitPrintExpr(PrintExpr &node) {
      std::vector<llvm::Value*> argsP;
      std::string formatStr = "";
     for(auto &arg:node.args){
-        arg->accept(*this);
-        if(lastValue){
-            argsP.push_back(lastValue);
-            if (lastValue->getType()->isDoubleTy()) {
+        llvm::Value *value = visit(*arg);
+        if(value){
+            // Varargs take a bool as an int.
+            value = convert(value, llvm::Type::getInt32Ty(*TheContext));
+            argsP.push_back(value);
+            if (value->getType()->isDoubleTy()) {
                 formatStr += "%f ";
-            } else if (lastValue->getType()->isIntegerTy()) {
+            } else if (value->getType()->isIntegerTy()) {
                 formatStr += "%d ";
-            } else if (lastValue->getType()->isPointerTy()) {
+            } else if (value->getType()->isPointerTy()) {
                 formatStr += "%s ";
             }
         }
@@ -251,85 +430,57 @@ void Codegen::visit(PrintExpr& node){
     );
     llvm::FunctionCallee calleeF = TheModule->getOrInsertFunction("printf", printfType);
     Builder->CreateCall(calleeF, argsP, "printfCall");
-    lastValue = nullptr;
+    return nullptr;
 }
 
-void Codegen::visit(CallExpr& node){
-    auto *fidentifier= TheModule->getFunction(node.identifier);
-
-    if(!fidentifier){
+llvm::Value *Codegen::visitCallExpr(CallExpr &node) {
+    if(!node.resolvedCallee){
         logerror("Undefined function call");
-        lastValue=nullptr;
-        return;
+        return nullptr;
     }
+    llvm::Function *fidentifier = declareFunction(*node.resolvedCallee);
     if(fidentifier->arg_size() !=  node.arguments.size()){
         logerror("incorrect no of parameters passsed to the function");
-        lastValue=nullptr;
-        return;
+        return nullptr;
     }
     std::vector<llvm::Value *> argsC;
     for(auto &arg : node.arguments){
-        arg->accept(*this);
-        if(lastValue){
-            argsC.push_back(lastValue);
+        if(llvm::Value *value = visit(*arg)){
+            argsC.push_back(convert(value, fidentifier->getArg(argsC.size())->getType()));
         }
     }
 
     if (fidentifier->getReturnType()->isVoidTy())
-        lastValue = Builder->CreateCall(fidentifier, argsC);
-    else
-        lastValue = Builder->CreateCall(fidentifier, argsC, "calltmp");
+        return Builder->CreateCall(fidentifier, argsC);
+    return Builder->CreateCall(fidentifier, argsC, "calltmp");
 }
 
-void Codegen::visit(NumberLiteral& node) {
-    if (node.resolvedType && *node.resolvedType == Type::FLOAT) {
-        double val = std::stod(node.value);
-        lastValue = llvm::ConstantFP::get(*TheContext, llvm::APFloat(val));
-    } else if (node.resolvedType && *node.resolvedType == Type::INT) {
-        lastValue = llvm::ConstantInt::get(*TheContext, 
-            llvm::APInt(32, std::stoll(node.value))
-        );
+llvm::Value *Codegen::visitNumberLiteral(NumberLiteral &node) {
+    if (node.resolvedType == Type::FLOAT) {
+        return llvm::ConstantFP::get(*TheContext, llvm::APFloat(node.floatValue));
     } else {
-        // Fallback or default behavior
-        if (node.value.find('.') != std::string::npos) {
-             lastValue = llvm::ConstantFP::get(*TheContext, 
-                llvm::APFloat(llvm::APFloat::IEEEdouble(), llvm::StringRef(node.value))
-            );
-        } else {
-             lastValue = llvm::ConstantInt::get(*TheContext, 
-                llvm::APInt(32, std::stoll(node.value))
-            );
-        }
+        return llvm::ConstantInt::get(*TheContext, 
+            llvm::APInt(32, node.intValue, /*isSigned=*/true)
+        );
     }
 }
 
 
 
-void Codegen::visit(StringLiteral& node){
-   lastValue = Builder->CreateGlobalString(node.value, "str", 0, TheModule.get());
-}
-
-void Codegen::visit(Stmt& node) {
-}
-
-void Codegen::visit(Expr& node) {
-}
-
-void Codegen::visit(ParamDecl& node) {
+llvm::Value *Codegen::visitStringLiteral(StringLiteral &node) {
+   return Builder->CreateGlobalString(node.value, "str", 0, TheModule.get());
 }
 
+llvm::Value *Codegen::visitBinaryExpr(BinaryExpr &node) {
+    if (node.op == TokenKind::amp_amp || node.op == TokenKind::pipe_pipe)
+        return emitLogicalExpr(node);
 
-void Codegen::visit(BinaryExpr& node) {
-    node.left->accept(*this);
-    llvm::Value* left = lastValue;
-    
-    node.right->accept(*this);
-    llvm::Value* right = lastValue;
-    
-    if (!left || !right) {
-        lastValue = nullptr;
-        return;
-    }
+    llvm::Value* left = visit(*node.left);
+    llvm::Value* right = visit(*node.right);
+    if (!left || !right)
+        return nullptr;
+    left = convert(left, llvm::Type::getInt32Ty(*TheContext));
+    right = convert(right, llvm::Type::getInt32Ty(*TheContext));
 
     bool leftIsDouble = left->getType()->isDoubleTy();
     bool rightIsDouble = right->getType()->isDoubleTy();
@@ -342,199 +493,222 @@ void Codegen::visit(BinaryExpr& node) {
              right = Builder->CreateSIToFP(right, llvm::Type::getDoubleTy(*TheContext), "casttmp");
     }
 
+    llvm::Value* result = nullptr;
     switch (node.op) {
         case TokenKind::plus:
             if (isDouble)
-                lastValue = Builder->CreateFAdd(left, right, "addtmp");
+                result = Builder->CreateFAdd(left, right, "addtmp");
             else
-                lastValue = Builder->CreateAdd(left, right, "addtmp");
+                result = Builder->CreateAdd(left, right, "addtmp");
             break;
         case TokenKind::minus:
             if (isDouble)
-                lastValue = Builder->CreateFSub(left, right, "subtmp");
+                result = Builder->CreateFSub(left, right, "subtmp");
             else
-                lastValue = Builder->CreateSub(left, right, "subtmp");
+                result = Builder->CreateSub(left, right, "subtmp");
             break;
         case TokenKind::mul:
             if (isDouble)
-                lastValue = Builder->CreateFMul(left, right, "multmp");
+                result = Builder->CreateFMul(left, right, "multmp");
             else
-                lastValue = Builder->CreateMul(left, right, "multmp");
+                result = Builder->CreateMul(left, right, "multmp");
             break;
         case TokenKind::slash:
             if (isDouble)
-                lastValue = Builder->CreateFDiv(left, right, "divtmp");
+                result = Builder->CreateFDiv(left, right, "divtmp");
             else
-                lastValue = Builder->CreateSDiv(left, right, "divtmp");
+                result = Builder->CreateSDiv(left, right, "divtmp");
             break;
         case TokenKind::percent:
             if (isDouble)
-                lastValue = Builder->CreateFRem(left, right, "modtmp");
+                result = Builder->CreateFRem(left, right, "modtmp");
             else
-                lastValue = Builder->CreateSRem(left, right, "modtmp");
+                result = Builder->CreateSRem(left, right, "modtmp");
             break;
         case TokenKind::lessthan:
             if (isDouble) {
-                lastValue = Builder->CreateFCmpOLT(left, right, "cmptmp");
-                lastValue = Builder->CreateUIToFP(lastValue, llvm::Type::getDoubleTy(*TheContext), "booltmp"); // Convert i1 to double if needed? No, keep as i1 for now, but wait, resolvedType says INT.
-                // Actually, comparisons return i1. We should probably zero-extend to i32 if we want to treat it as INT.
-                lastValue = Builder->CreateZExt(lastValue, llvm::Type::getInt32Ty(*TheContext), "booltmp");
+                result = Builder->CreateFCmpOLT(left, right, "cmptmp");
             } else {
-                lastValue = Builder->CreateICmpSLT(left, right, "cmptmp");
-                lastValue = Builder->CreateZExt(lastValue, llvm::Type::getInt32Ty(*TheContext), "booltmp");
+                result = Builder->CreateICmpSLT(left, right, "cmptmp");
             }
             break;
         case TokenKind::greaterthan:
             if (isDouble) {
-                lastValue = Builder->CreateFCmpOGT(left, right, "cmptmp");
-                lastValue = Builder->CreateZExt(lastValue, llvm::Type::getInt32Ty(*TheContext), "booltmp");
+                result = Builder->CreateFCmpOGT(left, right, "cmptmp");
             } else {
-                lastValue = Builder->CreateICmpSGT(left, right, "cmptmp");
-                lastValue = Builder->CreateZExt(lastValue, llvm::Type::getInt32Ty(*TheContext), "booltmp");
+                result = Builder->CreateICmpSGT(left, right, "cmptmp");
             }
             break;
         case TokenKind::less_equal:
             if (isDouble) {
-                lastValue = Builder->CreateFCmpOLE(left, right, "cmptmp");
-                lastValue = Builder->CreateZExt(lastValue, llvm::Type::getInt32Ty(*TheContext), "booltmp");
+                result = Builder->CreateFCmpOLE(left, right, "cmptmp");
             } else {
-                lastValue = Builder->CreateICmpSLE(left, right, "cmptmp");
-                lastValue = Builder->CreateZExt(lastValue, llvm::Type::getInt32Ty(*TheContext), "booltmp");
+                result = Builder->CreateICmpSLE(left, right, "cmptmp");
             }
             break;
         case TokenKind::great_equal:
             if (isDouble) {
-                lastValue = Builder->CreateFCmpOGE(left, right, "cmptmp");
-                lastValue = Builder->CreateZExt(lastValue, llvm::Type::getInt32Ty(*TheContext), "booltmp");
+                result = Builder->CreateFCmpOGE(left, right, "cmptmp");
             } else {
-                lastValue = Builder->CreateICmpSGE(left, right, "cmptmp");
-                lastValue = Builder->CreateZExt(lastValue, llvm::Type::getInt32Ty(*TheContext), "booltmp");
+                result = Builder->CreateICmpSGE(left, right, "cmptmp");
             }
             break;
         case TokenKind::doublequal:
             if (isDouble) {
-                lastValue = Builder->CreateFCmpOEQ(left, right, "cmptmp");
-                lastValue = Builder->CreateZExt(lastValue, llvm::Type::getInt32Ty(*TheContext), "booltmp");
+                result = Builder->CreateFCmpOEQ(left, right, "cmptmp");
             } else {
-                lastValue = Builder->CreateICmpEQ(left, right, "cmptmp");
-                lastValue = Builder->CreateZExt(lastValue, llvm::Type::getInt32Ty(*TheContext), "booltmp");
+                result = Builder->CreateICmpEQ(left, right, "cmptmp");
             }
             break;
         case TokenKind::not_equal:
             if (isDouble) {
-                lastValue = Builder->CreateFCmpONE(left, right, "cmptmp");
-                lastValue = Builder->CreateZExt(lastValue, llvm::Type::getInt32Ty(*TheContext), "booltmp");
+                result = Builder->CreateFCmpONE(left, right, "cmptmp");
             } else {
-                lastValue = Builder->CreateICmpNE(left, right, "cmptmp");
-                lastValue = Builder->CreateZExt(lastValue, llvm::Type::getInt32Ty(*TheContext), "booltmp");
+                result = Builder->CreateICmpNE(left, right, "cmptmp");
             }
             break;
         default:
             logerror("Unknown binary operator");
-            lastValue = nullptr;
             break;
     }
+    return result;
 }
 
-void Codegen::visit(Decl& node) {
-}
-
-void Codegen::visit(VariableDecl& node) {
+llvm::Value *Codegen::visitVariableDecl(VariableDecl &node) {
     llvm::Type* varType = GenerateType(node.type);
-    llvm::AllocaInst* alloca = Builder->CreateAlloca(varType, nullptr, node.identifier);
-    NamedValues[node.identifier] = alloca;
+    // Each time the declaration runs, the variable starts out unset.
+    llvm::Value* value = llvm::UndefValue::get(varType);
     if (node.initializer) {
-        node.initializer->accept(*this);
-        if (lastValue) {
-            llvm::Value* valueToStore = lastValue;
-            if (lastValue->getType() != varType) {
+        if (llvm::Value* initValue = visit(*node.initializer)) {
+            initValue = convert(initValue, varType);
+            if (initValue->getType() != varType) {
                 logerror("Variable declaration type mismatch");
-                return;
+                return nullptr;
             }
-            Builder->CreateStore(valueToStore, alloca);
+            value = initValue;
         }
     }
-    lastValue = nullptr;
+    writeVariable(node, Builder->GetInsertBlock(), value);
+    return nullptr;
 }
 
-void Codegen::visit(AssignmentExpr& node) {
-    llvm::Value* variable = NamedValues[node.target];
-    if (!variable) {
+llvm::Value *Codegen::visitAssignmentExpr(AssignmentExpr &node) {
+    const Decl* variable = node.resolvedTarget;
+    if (!llvm::isa_and_nonnull<VariableDecl, ParamDecl>(variable)) {
         logerror("Unknown variable in assignment");
-        lastValue = nullptr;
-        return;
+        return nullptr;
     }
-    node.value->accept(*this);
-    if (!lastValue) {
+    llvm::Value* valueToStore = visit(*node.value);
+    if (!valueToStore) {
         logerror("Failed to generate RHS of assignment");
-        return;
+        return nullptr;
     }
     
-    // Get the type of the variable (from the alloca)
-    llvm::Type* varType = llvm::cast<llvm::AllocaInst>(variable)->getAllocatedType();
-    llvm::Value* valueToStore = lastValue;
-    
-    // Cast the value to match the variable type if needed
-    if (lastValue->getType() != varType) {
+    valueToStore = convert(valueToStore, variableType(*variable));
+    if (valueToStore->getType() != variableType(*variable)) {
         logerror("Assignment type mismatch");
-        return;
+        return nullptr;
     }
     
-    Builder->CreateStore(valueToStore, variable);
+    writeVariable(*variable, Builder->GetInsertBlock(), valueToStore);
+    return valueToStore;
 }
 
-void Codegen::visit(BooleanLiteral& node) {
-    // Boolean is int (0 or 1)
-    lastValue = llvm::ConstantInt::get(*TheContext, llvm::APInt(32, node.value ? 1 : 0));
+llvm::Value *Codegen::visitBooleanLiteral(BooleanLiteral &node) {
+    return llvm::ConstantInt::getBool(*TheContext, node.value);
 }
 
-void Codegen::visit(IfStmt& node) {
-    node.condition->accept(*this);
-    llvm::Value* condValue = lastValue;
-    
-    if (!condValue) {
-        logerror("Failed to generate if condition");
-        return;
+llvm::Value *Codegen::convert(llvm::Value *value, llvm::Type *type) {
+    if (value->getType()->isIntegerTy(1) && type->isIntegerTy(32))
+        return Builder->CreateZExt(value, type, "booltmp");
+    return value;
+}
+
+llvm::Value *Codegen::toCondition(llvm::Value *value) {
+    if (value->getType()->isIntegerTy(1))
+        return value;
+    if (value->getType()->isDoubleTy())
+        return Builder->CreateFCmpONE(value, llvm::ConstantFP::get(*TheContext, llvm::APFloat(0.0)), "tobool");
+    if (value->getType()->isIntegerTy())
+        return Builder->CreateICmpNE(value, llvm::ConstantInt::get(value->getType(), 0), "tobool");
+    return nullptr;
+}
+
+bool Codegen::emitBranch(Expr &condition, llvm::BasicBlock *trueBB, llvm::BasicBlock *falseBB) {
+    auto *logical = llvm::dyn_cast<BinaryExpr>(&condition);
+    if (logical && (logical->op == TokenKind::amp_amp || logical->op == TokenKind::pipe_pipe)) {
+        bool isAnd = logical->op == TokenKind::amp_amp;
+        llvm::Function* function = Builder->GetInsertBlock()->getParent();
+        // The right operand runs only if the left one did not decide.
+        llvm::BasicBlock* rightBB = llvm::BasicBlock::Create(*TheContext, isAnd ? "and.rhs" : "or.rhs");
+        if (!emitBranch(*logical->left, isAnd ? rightBB : trueBB, isAnd ? falseBB : rightBB))
+            return false;
+        function->insert(function->end(), rightBB);
+        sealBlock(rightBB);
+        Builder->SetInsertPoint(rightBB);
+        return emitBranch(*logical->right, trueBB, falseBB);
     }
-    
-    // Convert condition to boolean by comparing with 0.0
-    // Convert condition to boolean
-    llvm::Value* condBool;
-    if (condValue->getType()->isDoubleTy()) {
-        condBool = Builder->CreateFCmpONE(
-            condValue, 
-            llvm::ConstantFP::get(*TheContext, llvm::APFloat(0.0)), 
-            "ifcond"
-        );
-    } else if (condValue->getType()->isIntegerTy()) {
-        condBool = Builder->CreateICmpNE(
-            condValue,
-            llvm::ConstantInt::get(condValue->getType(), 0),
-            "ifcond"
-        );
-    } else {
-        logerror("Invalid type for if condition");
-        return;
+
+    llvm::Value* value = visit(condition);
+    if (!value)
+        return false;
+    llvm::Value* condBool = toCondition(value);
+    if (!condBool) {
+        logerror("Invalid type for condition");
+        return false;
     }
-    
+    Builder->CreateCondBr(condBool, trueBB, falseBB);
+    return true;
+}
+
+// `&&` and `||` as a value: the branches of emitBranch, meeting at a phi
+// that is the right operand if it ran and the deciding constant otherwise.
+llvm::Value *Codegen::emitLogicalExpr(BinaryExpr &node) {
+    bool isAnd = node.op == TokenKind::amp_amp;
+    llvm::Function* function = Builder->GetInsertBlock()->getParent();
+    llvm::BasicBlock* rightBB = llvm::BasicBlock::Create(*TheContext, isAnd ? "and.rhs" : "or.rhs");
+    llvm::BasicBlock* mergeBB = llvm::BasicBlock::Create(*TheContext, isAnd ? "and.end" : "or.end");
+    if (!emitBranch(*node.left, isAnd ? rightBB : mergeBB, isAnd ? mergeBB : rightBB))
+        return nullptr;
+
+    function->insert(function->end(), rightBB);
+    sealBlock(rightBB);
+    Builder->SetInsertPoint(rightBB);
+    llvm::Value* right = visit(*node.right);
+    if (!right || !(right = toCondition(right)))
+        return nullptr;
+    llvm::BasicBlock* rightEnd = Builder->GetInsertBlock();
+    Builder->CreateBr(mergeBB);
+
+    function->insert(function->end(), mergeBB);
+    sealBlock(mergeBB);
+    Builder->SetInsertPoint(mergeBB);
+    llvm::PHINode* phi = Builder->CreatePHI(Builder->getInt1Ty(), 2, "booltmp");
+    for (llvm::BasicBlock* pred : llvm::predecessors(mergeBB))
+        phi->addIncoming(pred == rightEnd ? right : Builder->getInt1(!isAnd), pred);
+    return phi;
+}
+
+llvm::Value *Codegen::visitIfStmt(IfStmt &node) {
     llvm::Function* function = Builder->GetInsertBlock()->getParent();
     
     // Create blocks for then, else, and merge
-    llvm::BasicBlock* thenBB = llvm::BasicBlock::Create(*TheContext, "then", function);
+    llvm::BasicBlock* thenBB = llvm::BasicBlock::Create(*TheContext, "then");
     llvm::BasicBlock* elseBB = node.elseBlock ? 
         llvm::BasicBlock::Create(*TheContext, "else") : nullptr;
     llvm::BasicBlock* mergeBB = llvm::BasicBlock::Create(*TheContext, "ifcont");
     
     // Branch based on condition
-    if (elseBB) {
-        Builder->CreateCondBr(condBool, thenBB, elseBB);
-    } else {
-        Builder->CreateCondBr(condBool, thenBB, mergeBB);
+    if (!emitBranch(*node.condition, thenBB, elseBB ? elseBB : mergeBB)) {
+        logerror("Failed to generate if condition");
+        return nullptr;
     }
     
     // Generate then block
+    function->insert(function->end(), thenBB);
+    sealBlock(thenBB);
     Builder->SetInsertPoint(thenBB);
-    node.thenBlock->accept(*this);
+    visitBlock(*node.thenBlock);
     if (!Builder->GetInsertBlock()->getTerminator()) {
         Builder->CreateBr(mergeBB);
     }
@@ -542,8 +716,9 @@ void Codegen::visit(IfStmt& node) {
     // Generate else block if it exists
     if (elseBB) {
         function->insert(function->end(), elseBB);
+        sealBlock(elseBB);
         Builder->SetInsertPoint(elseBB);
-        node.elseBlock->accept(*this);
+        visitBlock(*node.elseBlock);
         if (!Builder->GetInsertBlock()->getTerminator()) {
             Builder->CreateBr(mergeBB);
         }
@@ -551,12 +726,13 @@ void Codegen::visit(IfStmt& node) {
     
     // Generate merge block
     function->insert(function->end(), mergeBB);
+    sealBlock(mergeBB);
     Builder->SetInsertPoint(mergeBB);
     
-    lastValue = nullptr;
+    return nullptr;
 }
 
-void Codegen::visit(WhileStmt& node) {
+llvm::Value *Codegen::visitWhileStmt(WhileStmt &node) {
     llvm::Function* function = Builder->GetInsertBlock()->getParent();
     
     // Create blocks for condition, body, and after loop
@@ -569,46 +745,27 @@ void Codegen::visit(WhileStmt& node) {
     
     // Generate condition block
     Builder->SetInsertPoint(condBB);
-    node.condition->accept(*this);
-    llvm::Value* condValue = lastValue;
-    
-    if (!condValue) {
+    if (!emitBranch(*node.condition, bodyBB, afterBB)) {
         logerror("Failed to generate while condition");
-        return;
+        sealBlock(condBB);
+        return nullptr;
     }
     
-    // Convert condition to boolean
-    llvm::Value* condBool;
-    if (condValue->getType()->isDoubleTy()) {
-        condBool = Builder->CreateFCmpONE(
-            condValue, 
-            llvm::ConstantFP::get(*TheContext, llvm::APFloat(0.0)), 
-            "whilecond"
-        );
-    } else if (condValue->getType()->isIntegerTy()) {
-        condBool = Builder->CreateICmpNE(
-            condValue,
-            llvm::ConstantInt::get(condValue->getType(), 0),
-            "whilecond"
-        );
-    } else {
-        logerror("Invalid type for while condition");
-        return;
-    }
-    
-    Builder->CreateCondBr(condBool, bodyBB, afterBB);
-    
     // Generate body block
     function->insert(function->end(), bodyBB);
+    sealBlock(bodyBB);
     Builder->SetInsertPoint(bodyBB);
-    node.body->accept(*this);
+    visitBlock(*node.body);
     if (!Builder->GetInsertBlock()->getTerminator()) {
         Builder->CreateBr(condBB);  // Loop back to condition
     }
+    // The back edge is in: the condition's phis can be completed.
+    sealBlock(condBB);
     
     // Generate after block
     function->insert(function->end(), afterBB);
+    sealBlock(afterBB);
     Builder->SetInsertPoint(afterBB);
     
-    lastValue = nullptr;
+    return nullptr;
 }
@@ -1,20 +1,38 @@
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include <system_error>
 #include <string>
 
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include "astcache.h"
+#include "incremental.h"
+#include "lazyfrontend.h"
 #include "lexer.h"
 #include "parser.h"
+#include "parallellexer.h"
+#include "parallelparser.h"
+#include "parallelsema.h"
+#include "pipelinedlexer.h"
+#include "scanner.h"
+#include "streamingfrontend.h"
 #include "ast.h"
+#include "astcontext.h"
 #include "sema.h"
+#include "sourcemanager.h"
 #include "codegen.h"
 
+#ifdef LLVM_ON_UNIX
+#include <sys/resource.h>
+#endif
+
 namespace cl = llvm::cl;
 
 static cl::opt<std::string> inputFilename(
@@ -24,56 +42,422 @@ static cl::opt<std::string> inputFilename(
     cl::value_desc("filename")
 );
 
+static cl::opt<bool> printStats(
+    "frontend-stats",
+    cl::desc("Print front-end timing and peak memory statistics"),
+    cl::init(false)
+);
+
+static cl::opt<bool> dumpTokens(
+    "dump-tokens",
+    cl::desc("Print the token stream before parsing"),
+    cl::init(false)
+);
+
+static cl::opt<scan::ISA> lexerISA(
+    "lexer-simd",
+    cl::desc("Instruction set used by the lexer's scanning loops"),
+    cl::values(
+        clEnumValN(scan::ISA::Auto, "auto", "Best one supported by the host (default)"),
+        clEnumValN(scan::ISA::Scalar, "scalar", "Portable byte-at-a-time loops"),
+        clEnumValN(scan::ISA::SSE2, "sse2", "16 bytes per step"),
+        clEnumValN(scan::ISA::AVX2, "avx2", "32 bytes per step")),
+    cl::init(scan::ISA::Auto)
+);
+
+static cl::opt<unsigned> lexThreads(
+    "lex-threads",
+    cl::desc("Lex the whole input up front in chunks on N threads "
+             "(0 = lex on demand while parsing)"),
+    cl::init(0)
+);
+
+static cl::opt<unsigned> parseThreads(
+    "parse-threads",
+    cl::desc("Parse top-level functions on N threads (0 = sequentially). "
+             "Lexes the whole input up front, on as many threads unless "
+             "-lex-threads says otherwise"),
+    cl::init(0)
+);
+
+static cl::opt<unsigned> semaThreads(
+    "sema-threads",
+    cl::desc("Check function bodies on N threads (0 = sequentially)"),
+    cl::init(0)
+);
+
+static cl::opt<bool> lazyBodies(
+    "lazy-bodies",
+    cl::desc("Parse, check and compile only the function bodies reachable "
+             "from main. Lexes the whole input up front"),
+    cl::init(false)
+);
+
+static cl::opt<bool> useASTCache(
+    "ast-cache",
+    cl::desc("Reuse the checked AST saved in <input>.astcache when the input "
+             "has not changed, and save it there when it has"),
+    cl::init(false)
+);
+
+static cl::opt<bool> streamFunctions(
+    "stream-functions",
+    cl::desc("Parse, check and lower one function at a time, releasing its "
+             "AST before reading the next, so front-end memory stays flat"),
+    cl::init(false)
+);
+
+static cl::opt<bool> constEval(
+    "const-eval",
+    cl::desc("Replace constant expressions, and calls that can be evaluated "
+             "at compile time, with their values after sema (default on)"),
+    cl::init(true)
+);
+
+static cl::opt<Codegen::OptLevel> optLevel(
+    cl::desc("Optimization level:"),
+    cl::values(
+        clEnumValN(Codegen::OptLevel::O0, "O0", "Only dead code removal and block merging"),
+        clEnumValN(Codegen::OptLevel::O1, "O1", "Optimize quickly"),
+        clEnumValN(Codegen::OptLevel::O2, "O2", "Optimize for speed"),
+        clEnumValN(Codegen::OptLevel::O3, "O3", "Optimize for speed, at any cost in size"),
+        clEnumValN(Codegen::OptLevel::Os, "Os", "Optimize for size")),
+    // No -O: the -O0 passes, and the backend's default level.
+    cl::init(Codegen::OptLevel::Default)
+);
+
+static cl::opt<std::string> editScript(
+    "edit-script",
+    cl::desc("Open the input as an editor would, apply the edits in <file> one "
+             "at a time and print the diagnostics after each. Each line is "
+             "'<offset> <removed length> <inserted text>'. Front end only"),
+    cl::value_desc("file"),
+    cl::init("")
+);
+
+static cl::opt<bool> pipelineLexer(
+    "pipeline-lexer",
+    cl::desc("Lex on a separate thread, running ahead of the parser"),
+    cl::init(false)
+);
+
+static cl::opt<bool> syntaxOnly(
+    "syntax-only",
+    cl::desc("Stop after parsing (e.g. to time the front end)"),
+    cl::init(false)
+);
+
+// Peak resident set size of the process in kilobytes, or 0 if unknown.
+static long peakRSSKilobytes() {
+#ifdef LLVM_ON_UNIX
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return usage.ru_maxrss;
+#endif
+    return 0;
+}
+
+static void reportFolded(size_t folded) {
+    if (printStats && constEval)
+        std::cerr << "[stats] constants folded: " << folded << "\n";
+}
+
+static void reportStat(const char *what, std::chrono::steady_clock::time_point start) {
+    if (!printStats) return;
+    auto elapsed = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    std::cerr << "[stats] " << what << ": " << elapsed << " ms, peak RSS "
+              << peakRSSKilobytes() << " KB\n";
+}
+
+static int writeObjectFile(Codegen &codegen) {
+    // Generate object file
+    std::cerr << "------------------Generating Object File------------------------\n";
+    if (codegen.GenerateObjectFile("output.o")) {
+        std::cerr << "Object file generated successfully: output.o\n";
+    } else {
+        std::cerr << "Failed to generate object file\n";
+        return 1;
+    }
+    
+    return 0;
+}
+
+// Dumps the checked program, lowers it to IR and writes output.o.
+static int runBackEnd(std::vector<FunctionDecl *> &program) {
+    std::cerr << "\n------------------AST After Semantic Analysis------------------------\n";
+    for (auto &&fn : program) {
+        fn->dump();
+    }
+    std::cerr << "\n------------------LLVM IR------------------------\n";
+    Codegen codegen{optLevel};
+    codegen.generate(program);
+    std::cerr << "\n\n";
+    return writeObjectFile(codegen);
+}
+
+// The whole pipeline, one function at a time: each function is dumped and
+// lowered as soon as it is checked, and its AST released.
+static int runStreaming(const SourceManager &sourceManager, const SourceFile &sourceFile) {
+    if (dumpTokens) {
+        TheLexer lexer{sourceManager, sourceFile};
+        lexer.debugPrintAllTokens();
+    }
+
+    auto parseStart = std::chrono::steady_clock::now();
+    ASTContext astContext;
+    StreamingFrontend frontend{sourceManager, sourceFile, astContext};
+    frontend.setConstantFolding(constEval);
+    frontend.parseSignatures();
+    reportStat("parse signatures", parseStart);
+    if (syntaxOnly)
+        return 0;
+
+    std::cerr << "\n------------------AST After Semantic Analysis------------------------\n";
+    auto streamStart = std::chrono::steady_clock::now();
+    Codegen codegen{optLevel};
+    bool success = frontend.run([&codegen](FunctionDecl &fn) {
+        fn.dump();
+        codegen.visitFunctionDecl(fn);
+    });
+    reportStat("parse+sema+codegen of bodies", streamStart);
+    if (printStats)
+        std::cerr << "[stats] streaming: " << frontend.getStats().functions << " functions, "
+                  << "largest body arena " << frontend.getStats().peakBodyMemory / 1024 << " KB, "
+                  << "signatures " << astContext.getTotalMemory() / 1024 << " KB\n";
+    reportFolded(frontend.getStats().constantsFolded);
+    if (!success) {
+        std::cerr << "\nSemantic analysis failed!\n";
+        return 1;
+    }
+
+    std::cerr << "\n------------------LLVM IR------------------------\n";
+    codegen.optimize();
+    codegen.writeIR();
+    std::cerr << "\n\n";
+    return writeObjectFile(codegen);
+}
+
+static void printDiagnostics(const IncrementalFrontend &frontend) {
+    for (const std::string &diag : frontend.getDiagnostics())
+        std::cerr << diag << "\n";
+}
+
+// Keeps the input up to date through the edits in -edit-script, the way an
+// editor would use the incremental front end, and dumps the final AST.
+static int runEditScript(const SourceFile &sourceFile) {
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> scriptOrErr =
+        llvm::MemoryBuffer::getFile(editScript, /*IsText=*/true);
+    if (std::error_code ec = scriptOrErr.getError()) {
+        llvm::errs() << "Could not open edit script: " << ec.message() << "\n";
+        return 1;
+    }
+    std::vector<TextEdit> edits;
+    unsigned badLine = 0;
+    if (!parseEditScript(scriptOrErr.get()->getBuffer(), edits, badLine)) {
+        llvm::errs() << formatDiagnostic(editScript, badLine, 1,
+                                         "expected '<offset> <removed length> <inserted text>'")
+                     << "\n";
+        return 1;
+    }
+
+    auto openStart = std::chrono::steady_clock::now();
+    IncrementalFrontend frontend{inputFilename, sourceFile.buffer.str()};
+    reportStat("open", openStart);
+    std::cerr << "\n------------------Diagnostics------------------------\n";
+    printDiagnostics(frontend);
+
+    for (size_t i = 0; i < edits.size(); ++i) {
+        auto editStart = std::chrono::steady_clock::now();
+        frontend.applyEdit(edits[i]);
+        if (printStats) {
+            auto elapsed = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - editStart).count();
+            const IncrementalFrontend::Stats &stats = frontend.getStats();
+            std::cerr << "[stats] edit " << i + 1 << ": " << elapsed << " ms, "
+                      << stats.bytesLexed << " bytes lexed, " << stats.unitsParsed
+                      << " units parsed, " << stats.functionsChecked << " functions checked\n";
+        }
+        std::cerr << "\n------------------Diagnostics After Edit " << i + 1
+                  << "------------------------\n";
+        printDiagnostics(frontend);
+    }
+
+    std::cerr << "\n------------------AST After Semantic Analysis------------------------\n";
+    for (FunctionDecl *fn : frontend.getFunctions())
+        fn->dump();
+    return frontend.getDiagnostics().empty() ? 0 : 1;
+}
+
+static void reportCache(const ASTCache &cache) {
+    if (!printStats) return;
+    std::cerr << "[stats] ast cache: " << ASTCache::getStatusName(cache.getStatus()) << ", "
+              << cache.getNumNodes() << " nodes, " << cache.getFileSize() / 1024 << " KB\n";
+}
+
 int main(int argc, const char **argv) {
     cl::ParseCommandLineOptions(argc, argv, "My Compiler\n");
     std::cout << "Input file: " << inputFilename << "\n";
     
+    auto loadStart = std::chrono::steady_clock::now();
+    // Regular files are memory-mapped (no null terminator needed, so LLVM
+    // never falls back to copying); "-" streams stdin into a heap buffer.
     llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> fileOrErr =
-      llvm::MemoryBuffer::getFileOrSTDIN(inputFilename);
+      llvm::MemoryBuffer::getFileOrSTDIN(inputFilename, /*IsText=*/false,
+                                         /*RequiresNullTerminator=*/false);
     if (std::error_code ec = fileOrErr.getError()) {
         llvm::errs() << "Could not open input file: " << ec.message() << "\n"; 
         return 1;
     }
-    auto buffer = fileOrErr.get()->getBuffer();
     
-    SourceFile sourceFile{inputFilename, buffer.str()};
+    SourceManager sourceManager;
+    const SourceFile &sourceFile =
+        sourceManager.addFile(inputFilename, std::move(fileOrErr.get()));
+    reportStat("load", loadStart);
+
+    scan::ISA isa = scan::selectISA(lexerISA);
+    if (printStats)
+        std::cerr << "[stats] lexer scanning: " << scan::isaName(isa) << "\n";
+
+    if ((lexThreads > 0 || parseThreads > 0 || lazyBodies) && pipelineLexer) {
+        llvm::errs() << "-lex-threads, -parse-threads and -lazy-bodies cannot be combined "
+                        "with -pipeline-lexer\n";
+        return 1;
+    }
+    if (parseThreads > 0 && lazyBodies) {
+        llvm::errs() << "-parse-threads and -lazy-bodies cannot be combined\n";
+        return 1;
+    }
+    if (semaThreads > 0 && (lazyBodies || streamFunctions)) {
+        llvm::errs() << "-sema-threads cannot be combined with -lazy-bodies or -stream-functions\n";
+        return 1;
+    }
+    if (streamFunctions && (lexThreads > 0 || parseThreads > 0 || lazyBodies ||
+                            pipelineLexer || useASTCache)) {
+        llvm::errs() << "-stream-functions cannot be combined with -lex-threads, "
+                        "-parse-threads, -lazy-bodies, -pipeline-lexer or -ast-cache\n";
+        return 1;
+    }
+    if (!editScript.empty() && (lexThreads > 0 || parseThreads > 0 || semaThreads > 0 ||
+                                lazyBodies || streamFunctions || pipelineLexer ||
+                                useASTCache || syntaxOnly || dumpTokens)) {
+        llvm::errs() << "-edit-script cannot be combined with other front-end options\n";
+        return 1;
+    }
+    if (streamFunctions)
+        return runStreaming(sourceManager, sourceFile);
+    if (!editScript.empty())
+        return runEditScript(sourceFile);
 
-    TheLexer lexer{sourceFile};
+    // The cache stands in for the whole front end, so it is skipped when
+    // the front end's output is what was asked for. A bit per option that
+    // changes the AST.
+    std::unique_ptr<ASTCache> cache;
+    if (useASTCache && inputFilename != "-" && !syntaxOnly && !dumpTokens) {
+        uint32_t mode = (lazyBodies ? 1 : 0) | (constEval ? 2 : 0);
+        cache = std::make_unique<ASTCache>(inputFilename + ".astcache", sourceFile, mode);
+    }
+    ASTContext astContext;
+    if (cache) {
+        auto cacheStart = std::chrono::steady_clock::now();
+        std::vector<FunctionDecl *> program;
+        bool hit = cache->load(astContext, program);
+        reportStat("load ast cache", cacheStart);
+        if (hit) {
+            reportCache(*cache);
+            return runBackEnd(program);
+        }
+    }
+
+    TheLexer lexer{sourceManager, sourceFile};
+    TokenSource *tokens = &lexer;
+    std::unique_ptr<TokenBuffer> lexedTokens;
+    std::unique_ptr<PipelinedLexer> pipelinedTokens;
+    if (pipelineLexer) {
+        pipelinedTokens = std::make_unique<PipelinedLexer>(sourceManager, sourceFile);
+        tokens = pipelinedTokens.get();
+    }
+    if (lexThreads > 0 || parseThreads > 0 || lazyBodies) {
+        auto lexStart = std::chrono::steady_clock::now();
+        unsigned threads = lexThreads > 0 ? lexThreads : std::max(parseThreads.getValue(), 1u);
+        lexedTokens = std::make_unique<TokenBuffer>(sourceManager, sourceFile, threads);
+        reportStat("lex", lexStart);
+        tokens = lexedTokens.get();
+    }
 
-    // lexer.debugPrintAllTokens();
+    if (dumpTokens)
+        tokens->debugPrintAllTokens();
 
-    Parser parse{lexer};
-    auto parsedprogram = parse.parseProgram();
+    auto parseStart = std::chrono::steady_clock::now();
+    std::vector<FunctionDecl *> parsedprogram;
+    std::unique_ptr<LazyFrontend> lazy;
+    if (lazyBodies) {
+        lazy = std::make_unique<LazyFrontend>(*lexedTokens, astContext);
+        lazy->setConstantFolding(constEval);
+        parsedprogram = lazy->parseSignatures();
+        reportStat("parse signatures", parseStart);
+    } else if (parseThreads > 0) {
+        ParallelParser parse{*lexedTokens, astContext, parseThreads};
+        parsedprogram = parse.parseProgram();
+        reportStat("parse", parseStart);
+        if (printStats)
+            std::cerr << "[stats] parse ranges: " << parse.getStats().ranges << ", "
+                      << parse.getStats().rangesReparsed << " re-parsed\n";
+    } else {
+        Parser parse{*tokens, astContext};
+        parsedprogram = parse.parseProgram();
+        reportStat(lexedTokens ? "parse" : "lex+parse", parseStart);
+    }
+    if (printStats)
+        std::cerr << "[stats] ast: " << astContext.getNumNodes() << " nodes, "
+                  << astContext.getBytesAllocated() / 1024 << " KB in a "
+                  << astContext.getTotalMemory() / 1024 << " KB arena\n";
+    pipelinedTokens.reset();
+    if (syntaxOnly)
+        return 0;
     
     // std::cerr << "\n------------------AST Before Semantic Analysis-----------------------\n";
     // for (auto &&fn : parsedprogram) {
     //     fn->dump();
     // }
-    SemanticAnalysis sema(parsedprogram);
-    bool success = sema.resolve();
+    auto semaStart = std::chrono::steady_clock::now();
+    bool success;
+    if (lazy) {
+        success = lazy->check();
+        parsedprogram = lazy->getReachableFunctions();
+        reportStat("parse+sema of reachable bodies", semaStart);
+        if (printStats)
+            std::cerr << "[stats] lazy: " << lazy->getStats().bodiesParsed << " of "
+                      << lazy->getStats().functions << " bodies parsed\n";
+        reportFolded(lazy->getStats().constantsFolded);
+    } else if (semaThreads > 0) {
+        ParallelSema sema{parsedprogram, sourceManager, semaThreads};
+        if (constEval) sema.setConstantFolding(&astContext);
+        success = sema.resolve();
+        reportStat("sema", semaStart);
+        if (printStats)
+            std::cerr << "[stats] sema runs: " << sema.getStats().runs << "\n";
+        reportFolded(sema.getStats().constantsFolded);
+    } else {
+        SemanticAnalysis sema(parsedprogram, sourceManager);
+        if (constEval) sema.setConstantFolding(&astContext);
+        success = sema.resolve();
+        reportStat("sema", semaStart);
+        reportFolded(sema.getFoldStats().folded);
+    }
     
     if (!success) {
         std::cerr << "\nSemantic analysis failed!\n";
         return 1;
     }
     
-    std::cerr << "\n------------------AST After Semantic Analysis------------------------\n";
-    for (auto &&fn : parsedprogram) {
-        fn->dump();
-    }
-    std::cerr << "\n------------------LLVM IR------------------------\n";
-    Codegen codegen; 
-    codegen.generate(parsedprogram);
-    std::cerr << "\n\n";
-    
-    // Generate object file
-    std::cerr << "------------------Generating Object File------------------------\n";
-    if (codegen.GenerateObjectFile("output.o")) {
-        std::cerr << "Object file generated successfully: output.o\n";
-    } else {
-        std::cerr << "Failed to generate object file\n";
-        return 1;
+    if (cache) {
+        auto storeStart = std::chrono::steady_clock::now();
+        if (!cache->store(parsedprogram))
+            llvm::errs() << "warning: could not write " << inputFilename << ".astcache\n";
+        reportStat("store ast cache", storeStart);
+        reportCache(*cache);
     }
-    
-    return 0;
-}
\ No newline at end of file
+
+    return runBackEnd(parsedprogram);
+}
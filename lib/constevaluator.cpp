@@ -0,0 +1,354 @@
+#include "constevaluator.h"
+#include <cmath>
+#include <limits>
+
+#include "llvm/ADT/SmallVector.h"
+
+void ConstantEvaluator::foldFunction(FunctionDecl &function) {
+    // One budget for every call evaluated in the body.
+    steps = 0;
+    if (function.body) foldBlock(*function.body);
+}
+
+void ConstantEvaluator::foldBlock(Block &block) {
+    for (size_t i = 0; i < block.statements.size(); ++i) {
+        Stmt *stmt = block.statements[i];
+        switch (stmt->getKind()) {
+        case NodeKind::VariableDecl: {
+            auto *decl = llvm::cast<VariableDecl>(stmt);
+            if (decl->initializer) decl->initializer = fold(decl->initializer);
+            break;
+        }
+        case NodeKind::ReturnStmt: {
+            auto *ret = llvm::cast<ReturnStmt>(stmt);
+            if (ret->expr) ret->expr = fold(ret->expr);
+            break;
+        }
+        case NodeKind::IfStmt: {
+            auto *ifStmt = llvm::cast<IfStmt>(stmt);
+            ifStmt->condition = fold(ifStmt->condition);
+            foldBlock(*ifStmt->thenBlock);
+            if (ifStmt->elseBlock) foldBlock(*ifStmt->elseBlock);
+            break;
+        }
+        case NodeKind::WhileStmt: {
+            auto *whileStmt = llvm::cast<WhileStmt>(stmt);
+            whileStmt->condition = fold(whileStmt->condition);
+            foldBlock(*whileStmt->body);
+            break;
+        }
+        default:
+            if (auto *expr = llvm::dyn_cast<Expr>(stmt))
+                block.setStatement(i, fold(expr));
+            break;
+        }
+    }
+}
+
+Expr *ConstantEvaluator::fold(Expr *expr) {
+    switch (expr->getKind()) {
+    case NodeKind::BinaryExpr: {
+        auto *binary = llvm::cast<BinaryExpr>(expr);
+        binary->left = fold(binary->left);
+        binary->right = fold(binary->right);
+        std::optional<Value> left = literalValue(*binary->left);
+        if (binary->op == TokenKind::amp_amp || binary->op == TokenKind::pipe_pipe) {
+            bool isAnd = binary->op == TokenKind::amp_amp;
+            if (!left) return expr;
+            if (isTrue(*left) != isAnd) return makeLiteral(*expr, makeBool(!isAnd));
+            std::optional<Value> right = literalValue(*binary->right);
+            if (!right) return expr;
+            return makeLiteral(*expr, makeBool(isTrue(*right)));
+        }
+        std::optional<Value> right = literalValue(*binary->right);
+        if (!left || !right) return expr;
+        if (std::optional<Value> value = apply(binary->op, *left, *right))
+            return makeLiteral(*expr, *value);
+        return expr;
+    }
+    case NodeKind::CallExpr: {
+        auto *callExpr = llvm::cast<CallExpr>(expr);
+        llvm::SmallVector<Value, 8> args;
+        for (size_t i = 0; i < callExpr->arguments.size(); ++i) {
+            Expr *arg = fold(callExpr->arguments[i]);
+            callExpr->setArgument(i, arg);
+            if (std::optional<Value> value = literalValue(*arg))
+                args.push_back(*value);
+        }
+        const FunctionDecl *callee = callExpr->resolvedCallee;
+        if (!callee || args.size() != callExpr->arguments.size() ||
+            (callee->resolvedType != Type::INT && callee->resolvedType != Type::FLOAT &&
+             callee->resolvedType != Type::BOOL))
+            return expr;
+        std::optional<Value> result;
+        if (!call(*callee, args, result) || !result) return expr;
+        ++stats.callsEvaluated;
+        return makeLiteral(*expr, *result);
+    }
+    case NodeKind::PrintExpr: {
+        auto *print = llvm::cast<PrintExpr>(expr);
+        for (size_t i = 0; i < print->args.size(); ++i)
+            print->setArgument(i, fold(print->args[i]));
+        return expr;
+    }
+    case NodeKind::AssignmentExpr: {
+        auto *assignment = llvm::cast<AssignmentExpr>(expr);
+        assignment->value = fold(assignment->value);
+        return expr;
+    }
+    default:
+        return expr;
+    }
+}
+
+std::optional<ConstantEvaluator::Value> ConstantEvaluator::literalValue(const Expr &expr) {
+    Value value;
+    if (auto *number = llvm::dyn_cast<NumberLiteral>(&expr)) {
+        value.type = *number->resolvedType;
+        if (value.type == Type::FLOAT)
+            value.floatValue = number->floatValue;
+        else
+            value.intValue = static_cast<int32_t>(number->intValue);
+        return value;
+    }
+    if (auto *boolean = llvm::dyn_cast<BooleanLiteral>(&expr))
+        return makeBool(boolean->value);
+    return std::nullopt;
+}
+
+std::optional<ConstantEvaluator::Value> ConstantEvaluator::apply(TokenKind op, Value left,
+                                                                 Value right) {
+    left = convert(left, Type::INT);
+    right = convert(right, Type::INT);
+    Value result;
+    if (left.type == Type::FLOAT || right.type == Type::FLOAT) {
+        double a = left.type == Type::FLOAT ? left.floatValue : left.intValue;
+        double b = right.type == Type::FLOAT ? right.floatValue : right.intValue;
+        result.type = Type::FLOAT;
+        switch (op) {
+        case TokenKind::plus: result.floatValue = a + b; return result;
+        case TokenKind::minus: result.floatValue = a - b; return result;
+        case TokenKind::mul: result.floatValue = a * b; return result;
+        case TokenKind::slash: result.floatValue = a / b; return result;
+        case TokenKind::percent: result.floatValue = std::fmod(a, b); return result;
+        default: break;
+        }
+        // Ordered comparisons: false if either side is a NaN.
+        result.type = Type::BOOL;
+        switch (op) {
+        case TokenKind::lessthan: result.intValue = a < b; return result;
+        case TokenKind::greaterthan: result.intValue = a > b; return result;
+        case TokenKind::less_equal: result.intValue = a <= b; return result;
+        case TokenKind::great_equal: result.intValue = a >= b; return result;
+        case TokenKind::doublequal: result.intValue = a == b; return result;
+        case TokenKind::not_equal: result.intValue = a < b || a > b; return result;
+        default: return std::nullopt;
+        }
+    }
+
+    int32_t a = left.intValue, b = right.intValue;
+    // Wrapping arithmetic, done unsigned to stay defined in C++.
+    auto wrap = [](uint32_t value) { return static_cast<int32_t>(value); };
+    result.type = Type::INT;
+    switch (op) {
+    case TokenKind::plus: result.intValue = wrap(uint32_t(a) + uint32_t(b)); return result;
+    case TokenKind::minus: result.intValue = wrap(uint32_t(a) - uint32_t(b)); return result;
+    case TokenKind::mul: result.intValue = wrap(uint32_t(a) * uint32_t(b)); return result;
+    case TokenKind::slash:
+    case TokenKind::percent:
+        if (b == 0 || (a == std::numeric_limits<int32_t>::min() && b == -1))
+            return std::nullopt;
+        result.intValue = op == TokenKind::slash ? a / b : a % b;
+        return result;
+    default: break;
+    }
+    result.type = Type::BOOL;
+    switch (op) {
+    case TokenKind::lessthan: result.intValue = a < b; return result;
+    case TokenKind::greaterthan: result.intValue = a > b; return result;
+    case TokenKind::less_equal: result.intValue = a <= b; return result;
+    case TokenKind::great_equal: result.intValue = a >= b; return result;
+    case TokenKind::doublequal: result.intValue = a == b; return result;
+    case TokenKind::not_equal: result.intValue = a != b; return result;
+    default: return std::nullopt;
+    }
+}
+
+// As the branch codegen emits: a bool, an int compared to 0, a float
+// ordered and unequal to 0.0.
+bool ConstantEvaluator::isTrue(Value value) {
+    if (value.type == Type::FLOAT) return value.floatValue < 0.0 || value.floatValue > 0.0;
+    return value.intValue != 0;
+}
+
+ConstantEvaluator::Value ConstantEvaluator::makeBool(bool value) {
+    Value result;
+    result.type = Type::BOOL;
+    result.intValue = value;
+    return result;
+}
+
+ConstantEvaluator::Value ConstantEvaluator::convert(Value value, std::optional<Type> type) {
+    if (value.type == Type::BOOL && type == Type::INT) value.type = Type::INT;
+    return value;
+}
+
+Expr *ConstantEvaluator::makeLiteral(const Expr &expr, Value value) {
+    ++stats.folded;
+    if (value.type == Type::BOOL)
+        return context.create<BooleanLiteral>(expr.location, value.intValue != 0);
+    if (value.type == Type::FLOAT)
+        return context.create<NumberLiteral>(expr.location, value.floatValue);
+    return context.create<NumberLiteral>(expr.location, static_cast<int64_t>(value.intValue));
+}
+
+bool ConstantEvaluator::call(const FunctionDecl &callee, llvm::ArrayRef<Value> args,
+                             std::optional<Value> &result) {
+    if (!callee.body || depth >= maxDepth || args.size() != callee.params.size())
+        return false;
+    Frame frame;
+    for (size_t i = 0; i < args.size(); ++i) {
+        Value arg = convert(args[i], callee.params[i]->resolvedType);
+        if (callee.params[i]->resolvedType != arg.type) return false;
+        frame[callee.params[i]] = arg;
+    }
+    ++depth;
+    result.reset();
+    Flow flow = execute(*callee.body, frame, result);
+    --depth;
+    if (flow == Flow::Fail) return false;
+    if (callee.resolvedType == Type::VOID) {
+        result.reset();
+        return true;
+    }
+    // A value-returning function must have returned one, of its type.
+    if (flow != Flow::Return || !result) return false;
+    result = convert(*result, callee.resolvedType);
+    return result->type == callee.resolvedType;
+}
+
+bool ConstantEvaluator::invoke(const CallExpr &expr, Frame &frame, std::optional<Value> &result) {
+    if (!expr.resolvedCallee) return false;
+    llvm::SmallVector<Value, 8> args;
+    for (const Expr *arg : expr.arguments) {
+        std::optional<Value> value = evaluate(*arg, frame);
+        if (!value) return false;
+        args.push_back(*value);
+    }
+    return call(*expr.resolvedCallee, args, result);
+}
+
+std::optional<ConstantEvaluator::Value> ConstantEvaluator::evaluate(const Expr &expr, Frame &frame) {
+    if (++steps > maxSteps) return std::nullopt;
+    switch (expr.getKind()) {
+    case NodeKind::NumberLiteral:
+    case NodeKind::BooleanLiteral:
+        return literalValue(expr);
+    case NodeKind::DeclRefExpr: {
+        auto it = frame.find(llvm::cast<DeclRefExpr>(expr).resolvedDecl);
+        if (it == frame.end()) return std::nullopt;
+        return it->second;
+    }
+    case NodeKind::BinaryExpr: {
+        const auto &binary = llvm::cast<BinaryExpr>(expr);
+        std::optional<Value> left = evaluate(*binary.left, frame);
+        if (!left) return std::nullopt;
+        if (binary.op == TokenKind::amp_amp || binary.op == TokenKind::pipe_pipe) {
+            bool isAnd = binary.op == TokenKind::amp_amp;
+            if (isTrue(*left) != isAnd) return makeBool(!isAnd);
+            std::optional<Value> right = evaluate(*binary.right, frame);
+            if (!right) return std::nullopt;
+            return makeBool(isTrue(*right));
+        }
+        std::optional<Value> right = evaluate(*binary.right, frame);
+        if (!right) return std::nullopt;
+        return apply(binary.op, *left, *right);
+    }
+    case NodeKind::AssignmentExpr: {
+        const auto &assignment = llvm::cast<AssignmentExpr>(expr);
+        if (!llvm::isa_and_nonnull<VariableDecl, ParamDecl>(assignment.resolvedTarget))
+            return std::nullopt;
+        std::optional<Value> value = evaluate(*assignment.value, frame);
+        if (!value) return std::nullopt;
+        value = convert(*value, assignment.resolvedTarget->resolvedType);
+        frame[assignment.resolvedTarget] = *value;
+        return value;
+    }
+    case NodeKind::CallExpr: {
+        std::optional<Value> result;
+        if (!invoke(llvm::cast<CallExpr>(expr), frame, result)) return std::nullopt;
+        return result;
+    }
+    default:
+        // Strings, and print, which has an effect.
+        return std::nullopt;
+    }
+}
+
+ConstantEvaluator::Flow ConstantEvaluator::execute(const Block &block, Frame &frame,
+                                                   std::optional<Value> &result) {
+    for (const Stmt *stmt : block.statements) {
+        Flow flow = execute(*stmt, frame, result);
+        if (flow != Flow::Next) return flow;
+    }
+    return Flow::Next;
+}
+
+ConstantEvaluator::Flow ConstantEvaluator::execute(const Stmt &stmt, Frame &frame,
+                                                   std::optional<Value> &result) {
+    if (++steps > maxSteps) return Flow::Fail;
+    switch (stmt.getKind()) {
+    case NodeKind::VariableDecl: {
+        const auto &decl = llvm::cast<VariableDecl>(stmt);
+        if (decl.resolvedType != Type::INT && decl.resolvedType != Type::FLOAT &&
+            decl.resolvedType != Type::BOOL)
+            return Flow::Fail;
+        if (!decl.initializer) {
+            // Unset until assigned; reading it first fails.
+            frame.erase(&decl);
+            return Flow::Next;
+        }
+        std::optional<Value> value = evaluate(*decl.initializer, frame);
+        if (!value) return Flow::Fail;
+        frame[&decl] = convert(*value, decl.resolvedType);
+        return Flow::Next;
+    }
+    case NodeKind::ReturnStmt: {
+        const auto &ret = llvm::cast<ReturnStmt>(stmt);
+        result.reset();
+        if (ret.expr) {
+            result = evaluate(*ret.expr, frame);
+            if (!result) return Flow::Fail;
+        }
+        return Flow::Return;
+    }
+    case NodeKind::IfStmt: {
+        const auto &ifStmt = llvm::cast<IfStmt>(stmt);
+        std::optional<Value> condition = evaluate(*ifStmt.condition, frame);
+        if (!condition) return Flow::Fail;
+        if (isTrue(*condition)) return execute(*ifStmt.thenBlock, frame, result);
+        if (ifStmt.elseBlock) return execute(*ifStmt.elseBlock, frame, result);
+        return Flow::Next;
+    }
+    case NodeKind::WhileStmt: {
+        const auto &whileStmt = llvm::cast<WhileStmt>(stmt);
+        while (true) {
+            if (++steps > maxSteps) return Flow::Fail;
+            std::optional<Value> condition = evaluate(*whileStmt.condition, frame);
+            if (!condition) return Flow::Fail;
+            if (!isTrue(*condition)) return Flow::Next;
+            Flow flow = execute(*whileStmt.body, frame, result);
+            if (flow != Flow::Next) return flow;
+        }
+    }
+    case NodeKind::CallExpr: {
+        // Called for its effect, if any; a void call has no value.
+        std::optional<Value> ignored;
+        return invoke(llvm::cast<CallExpr>(stmt), frame, ignored) ? Flow::Next : Flow::Fail;
+    }
+    default:
+        if (auto *expr = llvm::dyn_cast<Expr>(&stmt))
+            return evaluate(*expr, frame) ? Flow::Next : Flow::Fail;
+        return Flow::Fail;
+    }
+}
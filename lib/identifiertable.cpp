@@ -0,0 +1,6 @@
+#include "identifiertable.h"
+
+IdentifierTable &IdentifierTable::global() {
+    static IdentifierTable table;
+    return table;
+}
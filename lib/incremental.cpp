@@ -0,0 +1,308 @@
+#include "incremental.h"
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <tuple>
+
+#include "llvm/ADT/STLExtras.h"
+#include "lexer.h"
+#include "parser.h"
+#include "sema.h"
+
+namespace {
+// Puts a function back the way the parser left it, so that no type or
+// binding from an earlier check survives a new check that stops early.
+// Literals keep the types the parser gave them.
+class ClearSemaResults : public ASTVisitor<ClearSemaResults> {
+public:
+    void visitFunctionDecl(FunctionDecl &node) {
+        node.resolvedType.reset();
+        for (ParamDecl *param : node.params) visit(*param);
+        if (node.body) visit(*node.body);
+    }
+    void visitParamDecl(ParamDecl &node) { node.resolvedType.reset(); }
+    void visitVariableDecl(VariableDecl &node) {
+        node.resolvedType.reset();
+        if (node.initializer) visit(*node.initializer);
+    }
+    void visitBlock(Block &node) {
+        for (Stmt *stmt : node.statements) visit(*stmt);
+    }
+    void visitReturnStmt(ReturnStmt &node) {
+        if (node.expr) visit(*node.expr);
+    }
+    void visitIfStmt(IfStmt &node) {
+        visit(*node.condition);
+        visit(*node.thenBlock);
+        if (node.elseBlock) visit(*node.elseBlock);
+    }
+    void visitWhileStmt(WhileStmt &node) {
+        visit(*node.condition);
+        visit(*node.body);
+    }
+    void visitPrintExpr(PrintExpr &node) {
+        node.resolvedType.reset();
+        for (Expr *arg : node.args) visit(*arg);
+    }
+    void visitDeclRefExpr(DeclRefExpr &node) {
+        node.resolvedType.reset();
+        node.resolvedDecl = nullptr;
+    }
+    void visitCallExpr(CallExpr &node) {
+        node.resolvedType.reset();
+        node.resolvedCallee = nullptr;
+        for (Expr *arg : node.arguments) visit(*arg);
+    }
+    void visitBinaryExpr(BinaryExpr &node) {
+        node.resolvedType.reset();
+        visit(*node.left);
+        visit(*node.right);
+    }
+    void visitAssignmentExpr(AssignmentExpr &node) {
+        node.resolvedType.reset();
+        node.resolvedTarget = nullptr;
+        visit(*node.value);
+    }
+};
+}
+
+bool parseEditScript(llvm::StringRef script, std::vector<TextEdit> &edits, unsigned &badLine) {
+    unsigned lineNumber = 0;
+    while (!script.empty()) {
+        llvm::StringRef line;
+        std::tie(line, script) = script.split('\n');
+        ++lineNumber;
+        line = line.rtrim('\r');
+        if (line.trim().empty() || line.front() == '#')
+            continue;
+
+        TextEdit edit;
+        badLine = lineNumber;
+        if (line.consumeInteger(10, edit.offset) || !line.consume_front(" ") ||
+            line.consumeInteger(10, edit.removedLength))
+            return false;
+        if (!line.empty() && !line.consume_front(" "))
+            return false;
+        for (size_t i = 0; i < line.size(); ++i) {
+            if (line[i] != '\\') {
+                edit.insertedText += line[i];
+                continue;
+            }
+            if (++i == line.size())
+                return false;
+            switch (line[i]) {
+                case 'n': edit.insertedText += '\n'; break;
+                case 't': edit.insertedText += '\t'; break;
+                case '\\': edit.insertedText += '\\'; break;
+                default: return false;
+            }
+        }
+        edits.push_back(std::move(edit));
+    }
+    return true;
+}
+
+IncrementalFrontend::IncrementalFrontend(std::string path, std::string text)
+    : path(std::move(path)), text(std::move(text)) {
+    loadText();
+    update(0, 0, 0);  // no units yet: parses everything
+}
+
+void IncrementalFrontend::loadText() {
+    // The buffer is a view of `text`; the SourceManager is dropped before
+    // `text` changes again.
+    sourceManager = std::make_unique<SourceManager>();
+    file = &sourceManager->addFile(
+        path, llvm::MemoryBuffer::getMemBuffer(text, path, /*RequiresNullTerminator=*/false));
+}
+
+void IncrementalFrontend::applyEdit(const TextEdit &edit) {
+    size_t offset = std::min(edit.offset, text.size());
+    size_t removed = std::min(edit.removedLength, text.size() - offset);
+    sourceManager.reset();
+    text.replace(offset, removed, edit.insertedText);
+    loadText();
+    update(offset, offset + removed,
+           static_cast<ptrdiff_t>(edit.insertedText.size()) - static_cast<ptrdiff_t>(removed));
+}
+
+void IncrementalFrontend::update(size_t offset, size_t removedEnd, ptrdiff_t delta) {
+    stats = Stats{};
+    auto shifted = [delta](const Unit &unit) {
+        return static_cast<size_t>(static_cast<ptrdiff_t>(unit.begin) + delta);
+    };
+
+    // Start over at the unit holding the byte before the edit, since the
+    // token that ends there may run on into the edited text, or before
+    // that if the edit touches the unit's first token, which the unit
+    // before looked at. The first unit always starts at 0.
+    size_t first = llvm::partition_point(units, [&](const Unit &unit) {
+        return unit.begin < offset;
+    }) - units.begin();
+    if (first > 0) --first;
+    if (first > 0 && offset <= units[first].begin + units[first].leadLength) --first;
+    size_t restart = units.empty() ? 0 : units[first].begin;
+    // Old units that can be picked up again start past the edit.
+    size_t candidate = std::partition_point(units.begin() + first, units.end(),
+        [&](const Unit &unit) { return unit.begin <= removedEnd; }) - units.begin();
+
+    std::vector<Diagnostic> lexerDiagnostics, parserDiagnostics;
+    TheLexer lexer{*sourceManager, *file, restart, text.size()};
+    lexer.setDiagnosticBuffer(&lexerDiagnostics);
+    auto context = std::make_shared<ASTContext>();
+    Parser parser(lexer, *context);
+    parser.setDiagnosticBuffer(&parserDiagnostics);
+
+    std::vector<Unit> parsed;
+    size_t resume = units.size();                    // first old unit kept
+    size_t end = std::numeric_limits<size_t>::max();  // where that unit starts
+    while (true) {
+        const Token &next = parser.peekToken();
+        size_t nextOffset = file->getOffset(next.location);
+        if (!parsed.empty()) {
+            if (next.kind == TokenKind::eof) break;
+            while (candidate < units.size() && shifted(units[candidate]) < nextOffset)
+                ++candidate;
+            if (candidate < units.size() && shifted(units[candidate]) == nextOffset) {
+                resume = candidate;
+                end = nextOffset;
+                break;
+            }
+        }
+
+        Unit &unit = parsed.emplace_back();
+        unit.begin = parsed.size() == 1 ? restart : nextOffset;
+        unit.parsedBase = file->getLocation(unit.begin).id;
+        unit.leadLength = nextOffset + next.length - unit.begin;
+        unit.context = context;
+        if (next.kind == TokenKind::eof) break;
+        std::vector<FunctionDecl *> functions;
+        parser.parseTopLevelDecl(functions);
+        for (FunctionDecl *function : functions)
+            unit.functions.push_back(CheckedFunction{function});
+        unit.parserDiagnostics = std::move(parserDiagnostics);
+        parserDiagnostics.clear();
+    }
+
+    // Lexer diagnostics go to the unit they are located in. Those past
+    // `end` came from lexing the first kept unit's first token, and that
+    // unit has them already.
+    for (Diagnostic &diag : lexerDiagnostics) {
+        size_t at = file->getOffset(diag.location);
+        if (at >= end) continue;
+        auto unit = llvm::partition_point(parsed, [at](const Unit &unit) { return unit.begin <= at; });
+        std::prev(unit)->lexerDiagnostics.push_back(std::move(diag));
+    }
+
+    stats.bytesLexed = std::min(end, text.size()) - restart;
+    stats.unitsParsed = parsed.size();
+
+    // Functions that were replaced, or added: whoever looked up these
+    // names has to look again.
+    std::vector<Symbol> changedNames;
+    for (size_t i = first; i < resume; ++i)
+        for (const CheckedFunction &function : units[i].functions)
+            changedNames.push_back(function.decl->identifier);
+    for (const Unit &unit : parsed)
+        for (const CheckedFunction &function : unit.functions)
+            changedNames.push_back(function.decl->identifier);
+    llvm::sort(changedNames);
+    changedNames.erase(std::unique(changedNames.begin(), changedNames.end()), changedNames.end());
+
+    for (size_t i = resume; i < units.size(); ++i)
+        units[i].begin = shifted(units[i]);
+    units.erase(units.begin() + first, units.begin() + resume);
+    units.insert(units.begin() + first, std::make_move_iterator(parsed.begin()),
+                 std::make_move_iterator(parsed.end()));
+
+    check(changedNames);
+}
+
+void IncrementalFrontend::check(llvm::ArrayRef<Symbol> changedNames) {
+    auto dependsOnChange = [&](const CheckedFunction &function) {
+        for (Symbol name : function.globalLookups)
+            if (std::binary_search(changedNames.begin(), changedNames.end(), name))
+                return true;
+        return false;
+    };
+
+    // Signatures in file order, each seeing the functions before it, then
+    // bodies, each seeing all of them.
+    SemanticAnalysis sema(*sourceManager);
+    std::vector<CheckedFunction *> checked;
+    for (Unit &unit : units) {
+        for (CheckedFunction &function : unit.functions) {
+            if (function.needsCheck || (!changedNames.empty() && dependsOnChange(function))) {
+                FunctionDecl &decl = *function.decl;
+                ClearSemaResults().visit(decl);
+                function.signatureDiagnostics.clear();
+                function.bodyDiagnostics.clear();
+                function.globalLookups.clear();
+                sema.setDiagnosticBuffer(&function.signatureDiagnostics);
+                sema.setGlobalLookupLog(&function.globalLookups);
+                function.signatureResolved = sema.resolveFunctionSignature(decl);
+                checked.push_back(&function);
+            }
+            sema.declareFunction(*function.decl);
+        }
+    }
+
+    for (CheckedFunction *function : checked) {
+        if (function->signatureResolved) {
+            sema.setDiagnosticBuffer(&function->bodyDiagnostics);
+            sema.setGlobalLookupLog(&function->globalLookups);
+            sema.resolveFunctionBody(*function->decl);
+        }
+        std::vector<Symbol> &names = function->globalLookups;
+        llvm::sort(names);
+        names.erase(std::unique(names.begin(), names.end()), names.end());
+        function->needsCheck = false;
+    }
+    stats.functionsChecked = checked.size();
+}
+
+size_t IncrementalFrontend::currentOffset(const Unit &unit, SourceLocation location) const {
+    return unit.begin + (location.id - unit.parsedBase);
+}
+
+void IncrementalFrontend::report(std::vector<std::string> &out, const Unit &unit,
+                                 const Diagnostic &diag) const {
+    auto [line, col] = file->getLineAndColumn(currentOffset(unit, diag.location));
+    out.push_back(formatDiagnostic(path, line, col, diag.message));
+}
+
+std::vector<std::string> IncrementalFrontend::getDiagnostics() const {
+    std::vector<std::string> out;
+    std::vector<const Diagnostic *> syntax;
+    for (const Unit &unit : units) {
+        syntax.clear();
+        for (const Diagnostic &diag : unit.lexerDiagnostics) syntax.push_back(&diag);
+        for (const Diagnostic &diag : unit.parserDiagnostics) syntax.push_back(&diag);
+        std::stable_sort(syntax.begin(), syntax.end(), [](const Diagnostic *a, const Diagnostic *b) {
+            return a->location < b->location;
+        });
+        for (const Diagnostic *diag : syntax) report(out, unit, *diag);
+    }
+    for (const Unit &unit : units)
+        for (const CheckedFunction &function : unit.functions)
+            for (const Diagnostic &diag : function.signatureDiagnostics) report(out, unit, diag);
+    for (const Unit &unit : units)
+        for (const CheckedFunction &function : unit.functions)
+            for (const Diagnostic &diag : function.bodyDiagnostics) report(out, unit, diag);
+    return out;
+}
+
+std::vector<FunctionDecl *> IncrementalFrontend::getFunctions() const {
+    std::vector<FunctionDecl *> functions;
+    for (const Unit &unit : units)
+        for (const CheckedFunction &function : unit.functions)
+            functions.push_back(function.decl);
+    return functions;
+}
+
+std::vector<size_t> IncrementalFrontend::getUnitOffsets() const {
+    std::vector<size_t> offsets;
+    for (const Unit &unit : units)
+        offsets.push_back(unit.begin);
+    return offsets;
+}
@@ -0,0 +1,146 @@
+#include "lazyfrontend.h"
+#include <iostream>
+
+#include "parser.h"
+#include "sema.h"
+
+namespace {
+// The names a body calls, which are the functions it can reach. Found
+// from the syntax alone, before the body is checked, so a call that would
+// turn out to be an error still counts.
+class CollectCallees : public ASTVisitor<CollectCallees> {
+    std::vector<Symbol> &names;
+
+public:
+    explicit CollectCallees(std::vector<Symbol> &names) : names(names) {}
+
+    void visitBlock(Block &node) {
+        for (Stmt *stmt : node.statements) visit(*stmt);
+    }
+    void visitReturnStmt(ReturnStmt &node) {
+        if (node.expr) visit(*node.expr);
+    }
+    void visitIfStmt(IfStmt &node) {
+        visit(*node.condition);
+        visit(*node.thenBlock);
+        if (node.elseBlock) visit(*node.elseBlock);
+    }
+    void visitWhileStmt(WhileStmt &node) {
+        visit(*node.condition);
+        visit(*node.body);
+    }
+    void visitVariableDecl(VariableDecl &node) {
+        if (node.initializer) visit(*node.initializer);
+    }
+    void visitPrintExpr(PrintExpr &node) {
+        for (Expr *arg : node.args) visit(*arg);
+    }
+    void visitCallExpr(CallExpr &node) {
+        names.push_back(node.identifier);
+        for (Expr *arg : node.arguments) visit(*arg);
+    }
+    void visitBinaryExpr(BinaryExpr &node) {
+        visit(*node.left);
+        visit(*node.right);
+    }
+    void visitAssignmentExpr(AssignmentExpr &node) { visit(*node.value); }
+};
+}
+
+std::vector<FunctionDecl *> LazyFrontend::parseSignatures() {
+    TokenBuffer::Cursor cursor(tokens, 0);
+    Parser parser(cursor, context);
+    parser.setSkipFunctionBodies(true);
+    functions = parser.parseProgram();
+    stats = Stats{};
+    stats.functions = functions.size();
+    return functions;
+}
+
+bool LazyFrontend::parseBody(FunctionDecl &function, std::vector<Diagnostic> &diagnostics) {
+    // Both passes read the same tokens, and the first one reported their
+    // lexer diagnostics already.
+    std::vector<Diagnostic> reported;
+    // A signature holds no braces: the body starts at the first '{'.
+    TokenBuffer::Cursor scan(tokens, tokens.findToken(function.location));
+    scan.setDiagnosticBuffer(&reported);
+    while (scan.getNextToken().kind != TokenKind::lbrace) {}
+
+    TokenBuffer::Cursor cursor(tokens, scan.getLastIndex());
+    cursor.setDiagnosticBuffer(&reported);
+    Parser parser(cursor, context);
+    parser.setDiagnosticBuffer(&diagnostics);
+    function.body = parser.parseBody();
+    ++stats.bodiesParsed;
+    return function.body != nullptr;
+}
+
+bool LazyFrontend::check() {
+    SemanticAnalysis sema(tokens.getSourceManager());
+    if (foldConstants) sema.setConstantFolding(&context);
+    // What a name in the global scope refers to: the first function
+    // declared with it, as in lookupDecl. Indexed by Symbol::id.
+    std::vector<size_t> byName;
+    constexpr size_t none = ~size_t(0);
+    for (size_t i = 0; i < functions.size(); ++i) {
+        FunctionDecl &function = *functions[i];
+        if (!sema.resolveFunctionSignature(function))
+            return false;
+        sema.declareFunction(function);
+        Symbol name = function.identifier;
+        if (name.id >= byName.size()) byName.resize(name.id + 1, none);
+        if (byName[name.id] == none) byName[name.id] = i;
+    }
+
+    reached.assign(functions.size(), false);
+    std::vector<size_t> queue;
+    auto reach = [&](Symbol name) {
+        if (name.id >= byName.size() || byName[name.id] == none) return;
+        size_t index = byName[name.id];
+        if (reached[index]) return;
+        reached[index] = true;
+        queue.push_back(index);
+    };
+    reach(IdentifierTable::global().intern("main"));
+    if (queue.empty()) {
+        std::cerr << "error: no 'main' function to start from\n";
+        return false;
+    }
+
+    // Find every reachable body first, then check them in file order, so
+    // that the first error reported is the one a whole-program run reports
+    // (unless that one is in a body main cannot reach).
+    std::vector<std::vector<Diagnostic>> syntaxErrors(functions.size());
+    std::vector<Symbol> callees;
+    bool parsed = true;
+    for (size_t next = 0; next < queue.size(); ++next) {
+        FunctionDecl &function = *functions[queue[next]];
+        if (!parseBody(function, syntaxErrors[queue[next]])) {
+            parsed = false;
+            continue;
+        }
+        callees.clear();
+        CollectCallees(callees).visit(*function.body);
+        for (Symbol name : callees) reach(name);
+    }
+    for (const std::vector<Diagnostic> &errors : syntaxErrors)
+        for (const Diagnostic &diag : errors)
+            std::cerr << formatDiagnostic(tokens.getSourceManager(), diag) << "\n";
+    if (!parsed)
+        return false;
+
+    std::vector<FunctionDecl *> reachable = getReachableFunctions();
+    for (FunctionDecl *function : reachable)
+        if (!sema.resolveFunctionBody(*function))
+            return false;
+    sema.foldConstants(reachable);
+    stats.constantsFolded = sema.getFoldStats().folded;
+    return true;
+}
+
+std::vector<FunctionDecl *> LazyFrontend::getReachableFunctions() const {
+    std::vector<FunctionDecl *> result;
+    for (size_t i = 0; i < functions.size(); ++i)
+        if (i < reached.size() && reached[i]) result.push_back(functions[i]);
+    return result;
+}
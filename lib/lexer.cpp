@@ -1,6 +1,12 @@
 #include "lexer.h"
+#include "scanner.h"
 #include "utils.h"
+#include <array>
+#include <charconv>
+#include <climits>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <iostream>
 
 namespace {
@@ -12,189 +18,305 @@ bool isNum(char c) {
     return c >= '0' && c <= '9';
 }
 
-bool isAlphanum(char c) {
-    return (isAlpha(c) || isNum(c));
+bool isIdentChar(char c) {
+    return isAlpha(c) || isNum(c);
 }
 
 bool iswhitespace(char c) {
     return c == ' ' || c == '\f' || c == '\n' || c == '\r' || c == '\t' || c == '\v';
 }
-}
 
+// Perfect hash over TOKEN_KEYWORDS, generated at compile time: a seed is
+// searched for that maps every keyword to its own slot of a 32-entry table
+// using only the length and the first and last characters. Recognizing an
+// identifier then costs one hash, one table load and at most one compare.
+struct Keyword {
+    std::string_view spelling;
+    TokenKind kind;
+};
 
-Token TheLexer::getNextToken() {
-    char c = lastChar;
-    
-    // Skip whitespace
-    while (iswhitespace(c)) c = getNextChar();
-    
-    SourceLocation loc = getSourceLocation();
-
-    if (c == EOF) return Token{loc, TokenKind::eof};
-
-    // Comments
-    if (c == '#') {
-        do { c = getNextChar(); } while (c != EOF && c != '\n');
-        return getNextToken();
+constexpr Keyword keywords[] = {
+#define KEYWORD(kind, spelling, name) {spelling, TokenKind::kind},
+    TOKEN_KEYWORDS(KEYWORD)
+#undef KEYWORD
+};
+constexpr size_t keywordTableSize = 32;
+
+constexpr size_t keywordHash(std::string_view s, unsigned seed) {
+    return (static_cast<unsigned char>(s.front()) * seed +
+            static_cast<unsigned char>(s.back()) + s.size()) % keywordTableSize;
+}
+
+constexpr bool isPerfectSeed(unsigned seed) {
+    bool used[keywordTableSize] = {};
+    for (const Keyword &kw : keywords) {
+        size_t slot = keywordHash(kw.spelling, seed);
+        if (used[slot]) return false;
+        used[slot] = true;
     }
-    
-    if (c == '/') {
-        if (peekNextChar() == '/') {
-            do { c = getNextChar(); } while (c != EOF && c != '\n');
-            return getNextToken();
-        } else if (peekNextChar() == '*') {
-            getNextChar(); // eat /
-            getNextChar(); // eat *
-            c = lastChar;
-            while (c != EOF) {
-                if (c == '*' && peekNextChar() == '/') {
-                    getNextChar(); // eat *
-                    getNextChar(); // eat /
-                    c = lastChar;
-                    break;
-                }
-                c = getNextChar();
-            }
-            return getNextToken();
+    return true;
+}
+
+constexpr unsigned findKeywordSeed() {
+    for (unsigned seed = 1; seed < 256; ++seed)
+        if (isPerfectSeed(seed)) return seed;
+    return 0;
+}
+
+constexpr unsigned keywordSeed = findKeywordSeed();
+static_assert(keywordSeed != 0, "no perfect hash for TOKEN_KEYWORDS; grow keywordTableSize");
+
+constexpr size_t minKeywordLength() {
+    size_t len = SIZE_MAX;
+    for (const Keyword &kw : keywords) len = kw.spelling.size() < len ? kw.spelling.size() : len;
+    return len;
+}
+constexpr size_t maxKeywordLength() {
+    size_t len = 0;
+    for (const Keyword &kw : keywords) len = kw.spelling.size() > len ? kw.spelling.size() : len;
+    return len;
+}
+
+// Slot -> index into `keywords`, or -1 for an empty slot.
+constexpr std::array<int8_t, keywordTableSize> buildKeywordTable() {
+    std::array<int8_t, keywordTableSize> table{};
+    for (auto &slot : table) slot = -1;
+    for (size_t i = 0; i < std::size(keywords); ++i)
+        table[keywordHash(keywords[i].spelling, keywordSeed)] = static_cast<int8_t>(i);
+    return table;
+}
+
+constexpr std::array<int8_t, keywordTableSize> keywordTable = buildKeywordTable();
+}
+
+TokenKind classifyIdentifier(std::string_view id) {
+    if (id.size() < minKeywordLength() || id.size() > maxKeywordLength())
+        return TokenKind::identifier;
+    int8_t slot = keywordTable[keywordHash(id, keywordSeed)];
+    if (slot >= 0 && keywords[slot].spelling == id)
+        return keywords[slot].kind;
+    return TokenKind::identifier;
+}
+
+void TheLexer::error(size_t offset, std::string_view message) const {
+    Diagnostic diag{sourceFile->getLocation(offset), std::string(message)};
+    if (diagnosticBuffer)
+        diagnosticBuffer->push_back(std::move(diag));
+    else
+        std::cerr << formatDiagnostic(*SM, diag) << "\n";
+}
+
+void TheLexer::skipWhitespaceAndComments() {
+    const char *begin = buffer.data();
+    const char *end = begin + buffer.size();
+    while (!atEnd()) {
+        char c = peekChar();
+        if (iswhitespace(c)) {
+            // Most runs are a single space between tokens; only hand longer
+            // ones (indentation, blank lines) to the vector scanner.
+            ++idx;
+            if (!atEnd() && iswhitespace(peekChar()))
+                idx = scan::skipWhitespace(begin + idx + 1, end) - begin;
+            continue;
+        }
+
+        // Line comments
+        if (c == '#' || (c == '/' && peekChar(1) == '/')) {
+            idx = scan::findNewline(begin + idx + 1, end) - begin;
+            continue;
+        }
+
+        // Block comments
+        if (c == '/' && peekChar(1) == '*') {
+            const char *close = scan::findBlockCommentEnd(begin + idx + 2, end);
+            idx = close == end ? buffer.size() : close + 2 - begin;
+            continue;
         }
+        return;
     }
+}
 
-    if (c == '"') {
-        std::string value;
-        getNextChar(); // eat "
-        c = lastChar;
-        while (c != '"' && c != EOF) {
-            if (c == '\\') {
-                c = getNextChar();
-                switch (c) {
-                    case 'n': value += '\n'; break;
-                    case 't': value += '\t'; break;
-                    case '\\': value += '\\'; break;
-                    case '"': value += '"'; break;
-                    default: value += c; break;
-                }
-            } else {
-                value += c;
-            }
-            getNextChar();
-            c = lastChar;
+llvm::StringRef TokenSource::getStringValue(const Token &tok, std::string &storage) const {
+    llvm::StringRef spelling = getSpelling(tok);
+    char quote = spelling.front();
+    llvm::StringRef body = spelling.drop_front();
+    if (!body.empty() && body.back() == quote)
+        body = body.drop_back();
+
+    // Single-quoted literals are taken verbatim.
+    if (quote != '"' || body.find('\\') == llvm::StringRef::npos)
+        return body;
+
+    storage.clear();
+    storage.reserve(body.size());
+    for (size_t i = 0; i < body.size(); ++i) {
+        char c = body[i];
+        if (c != '\\' || i + 1 == body.size()) {
+            storage += c;
+            continue;
+        }
+        c = body[++i];
+        switch (c) {
+            case 'n': storage += '\n'; break;
+            case 't': storage += '\t'; break;
+            case '\\': storage += '\\'; break;
+            case '"': storage += '"'; break;
+            default: storage += c; break;
         }
-        if (c == '"') {
-            getNextChar(); // eat closing "
-            return Token{loc, TokenKind::string_literal, std::move(value)};
-        } else {
-            std::cerr << loc.filepath << ":" << loc.line << ":" << loc.col 
-                      << ": error: unterminated string literal\n";
-            return Token{loc, TokenKind::string_literal, std::move(value)};
+    }
+    return storage;
+}
+
+// Decodes the digits and dots in [start, idx). Malformed or out-of-range
+// literals are diagnosed here and come back as unk tokens.
+Token TheLexer::lexNumber(size_t start) {
+    std::string_view text(buffer.data() + start, idx - start);
+    size_t dot = text.find('.');
+    Token tok = formToken(dot == std::string_view::npos ? TokenKind::int_literal
+                                                        : TokenKind::float_literal, start);
+    const char *first = text.data();
+    const char *last = first + text.size();
+
+    if (dot != std::string_view::npos && text.find('.', dot + 1) != std::string_view::npos) {
+        error(start, "invalid number literal '" + std::string(text) + "': more than one '.'");
+        tok.kind = TokenKind::unk;
+        return tok;
+    }
+
+    if (tok.kind == TokenKind::int_literal) {
+        auto [ptr, ec] = std::from_chars(first, last, tok.intValue);
+        // `int` is 32 bits wide.
+        if (ec != std::errc() || tok.intValue > INT32_MAX) {
+            error(start, "integer literal '" + std::string(text) + "' is too large for type 'int'");
+            tok.kind = TokenKind::unk;
+            tok.intValue = 0;
         }
+        return tok;
     }
 
-    if (c == '\'') {
-        std::string value;
-        getNextChar();
-        c = lastChar;
-        while (c != '\'' && c != EOF) {
-            value += c;
-            getNextChar();
-            c = lastChar;
+    // Digits around a single '.' always read to the end, as they do for
+    // strtod, so only the range can be wrong.
+    auto [ptr, ec] = std::from_chars(first, last, tok.floatValue);
+    if (ec == std::errc())
+        return tok;
+    error(start, "floating-point literal '" + std::string(text) + "' is out of range");
+    tok.kind = TokenKind::unk;
+    tok.floatValue = 0;
+    return tok;
+}
+
+Token TheLexer::getNextToken() {
+    skipWhitespaceAndComments();
+
+    size_t start = idx;
+    auto makeToken = [&](TokenKind kind) {
+        return formToken(kind, start);
+    };
+
+    if (atEnd()) return makeToken(TokenKind::eof);
+
+    char c = peekChar();
+
+    const char *begin = buffer.data();
+    const char *end = begin + buffer.size();
+
+    if (c == '"' || c == '\'') {
+        char quote = c;
+        const char *p = begin + idx + 1; // skip opening quote
+        while (true) {
+            p = scan::findStringDelimiter(p, end, quote);
+            if (p == end || *p == quote) break;
+            // A '\' escapes the next character, unless it is the last one.
+            p = end - p > 1 ? p + 2 : end;
         }
-        if (c == '\'') {
-            getNextChar();
-            return Token{loc, TokenKind::string_literal, std::move(value)};
-        } else {
-            std::cerr << loc.filepath << ":" << loc.line << ":" << loc.col 
-                      << ": error: unterminated string literal\n";
-            return Token{loc, TokenKind::string_literal, std::move(value)};
+        idx = p - begin;
+        if (atEnd()) {
+            error(start, "unterminated string literal");
+            return makeToken(TokenKind::string_literal);
         }
+        advance(); // eat closing quote
+        return makeToken(TokenKind::string_literal);
     }
 
     if (isAlpha(c)) {
-        std::string idStr;
-        while (isAlphanum(c)){
-            idStr += c;
-            getNextChar();
-            c=lastChar;
-        }
+        // Short identifiers and keywords are done before a vector step pays off.
+        advance();
+        while (!atEnd() && idx - start < 8 && isIdentChar(peekChar())) advance();
+        if (idx - start == 8)
+            idx = scan::skipIdentifierChars(begin + idx, end) - begin;
 
-        if (idStr == "func") return Token{loc, TokenKind::func};
-        if (idStr == "print") return Token{loc, TokenKind::print};
-        if (idStr == "return") return Token{loc, TokenKind::cf_return};
-        if (idStr == "int") return Token{loc, TokenKind::cf_int};
-        if (idStr == "float") return Token{loc, TokenKind::cf_float};
-        if (idStr == "if") return Token{loc, TokenKind::cf_if};
-        if (idStr == "else") return Token{loc, TokenKind::cf_else};
-        if (idStr == "while") return Token{loc, TokenKind::cf_while};
-        if (idStr == "var") return Token{loc, TokenKind::cf_var};
-        if (idStr == "true") return Token{loc, TokenKind::cf_true};
-        if (idStr == "false") return Token{loc, TokenKind::cf_false};
-        return Token{loc, TokenKind::identifier, idStr};
+        std::string_view idStr(buffer.data() + start, idx - start);
+        Token tok = makeToken(classifyIdentifier(idStr));
+        if (tok.kind == TokenKind::identifier)
+            tok.symbol = identifiers->intern(llvm::StringRef(idStr.data(), idStr.size()));
+        return tok;
     }
 
-    if (isNum(c) ||  (c == '.' && isNum(peekNextChar()))) {
-        std::string numStr;
-        while (isNum(c) || c == '.'){ 
-            numStr += c; 
-            getNextChar(); 
-            c=lastChar;
-        }
-        return Token{loc, TokenKind::number, numStr};
+    if (isNum(c) ||  (c == '.' && isNum(peekChar(1)))) {
+        while (!atEnd() && (isNum(peekChar()) || peekChar() == '.'))
+            advance();
+        return lexNumber(start);
     }
 
+    // Consumes `n` characters and forms a token of the given kind.
+    auto punct = [&](TokenKind kind, int n) {
+        while (n--) advance();
+        return makeToken(kind);
+    };
+    char next = peekChar(1);
+
     switch (c) {
-        case '(': getNextChar(); return Token{loc, TokenKind::lpar};
-        case ')': getNextChar(); return Token{loc, TokenKind::rpar};
-        case '{': getNextChar(); return Token{loc, TokenKind::lbrace};
-        case '}': getNextChar(); return Token{loc, TokenKind::rbrace};
-        case ':': getNextChar(); return Token{loc, TokenKind::colon};
-        case ';': getNextChar(); return Token{loc, TokenKind::semi};
-        case ',': getNextChar(); return Token{loc, TokenKind::comma};
-        
-        case '=': 
-            if (peekNextChar() == '=') { getNextChar(); getNextChar(); return Token{loc,TokenKind::doublequal}; }
-            getNextChar(); return Token{loc,TokenKind::equal};
-            
-        case '+': 
-            if (peekNextChar() == '+') { getNextChar(); getNextChar(); return Token{loc,TokenKind::increament}; }
-            if (peekNextChar() == '=') { getNextChar(); getNextChar(); return Token{loc, TokenKind::plus_equal}; }
-            getNextChar(); return Token{loc,TokenKind::plus};
-            
-        case '-': 
-            if (peekNextChar() == '-') { getNextChar(); getNextChar(); return Token{loc,TokenKind::decreament}; }
-            if (peekNextChar() == '=') { getNextChar(); getNextChar(); return Token{loc,TokenKind::minus_equal}; }
-            getNextChar(); return Token{loc,TokenKind::minus};
-            
-        case '*': 
-            if (peekNextChar() == '=') { getNextChar(); getNextChar(); return Token{loc,TokenKind::mul_equal}; }
-            getNextChar(); return Token{loc,TokenKind::mul};
-            
-        case '/':
-            getNextChar(); return Token{loc, TokenKind::slash};
-            
-        case '%': getNextChar(); return Token{loc, TokenKind::percent};
-        
+        case '(': return punct(TokenKind::lpar, 1);
+        case ')': return punct(TokenKind::rpar, 1);
+        case '{': return punct(TokenKind::lbrace, 1);
+        case '}': return punct(TokenKind::rbrace, 1);
+        case ':': return punct(TokenKind::colon, 1);
+        case ';': return punct(TokenKind::semi, 1);
+        case ',': return punct(TokenKind::comma, 1);
+
+        case '=':
+            if (next == '=') return punct(TokenKind::doublequal, 2);
+            return punct(TokenKind::equal, 1);
+
+        case '+':
+            if (next == '+') return punct(TokenKind::increament, 2);
+            if (next == '=') return punct(TokenKind::plus_equal, 2);
+            return punct(TokenKind::plus, 1);
+
+        case '-':
+            if (next == '-') return punct(TokenKind::decreament, 2);
+            if (next == '=') return punct(TokenKind::minus_equal, 2);
+            return punct(TokenKind::minus, 1);
+
+        case '*':
+            if (next == '=') return punct(TokenKind::mul_equal, 2);
+            return punct(TokenKind::mul, 1);
+
+        case '/': return punct(TokenKind::slash, 1);
+
+        case '%': return punct(TokenKind::percent, 1);
+
         case '<':
-            if (peekNextChar() == '=') { getNextChar(); getNextChar(); return Token{loc,TokenKind::less_equal}; }
-            getNextChar(); return Token{loc,TokenKind::lessthan};
-            
+            if (next == '=') return punct(TokenKind::less_equal, 2);
+            return punct(TokenKind::lessthan, 1);
+
         case '>':
-            if (peekNextChar() == '=') { getNextChar(); getNextChar(); return Token{loc,TokenKind::great_equal}; }
-            getNextChar(); return Token{loc,TokenKind::greaterthan};
-            
+            if (next == '=') return punct(TokenKind::great_equal, 2);
+            return punct(TokenKind::greaterthan, 1);
+
         case '!':
-            if (peekNextChar() == '=') { getNextChar(); getNextChar(); return Token{loc,TokenKind::not_equal}; }
-            getNextChar(); return Token{loc,TokenKind::negate};
-            
+            if (next == '=') return punct(TokenKind::not_equal, 2);
+            return punct(TokenKind::negate, 1);
+
         case '&':
-            if (peekNextChar() == '&') { getNextChar(); getNextChar(); return Token{loc, TokenKind::amp_amp}; }
+            if (next == '&') return punct(TokenKind::amp_amp, 2);
             break;
-            
+
         case '|':
-            if (peekNextChar() == '|') { getNextChar(); getNextChar(); return Token{loc, TokenKind::pipe_pipe}; }
+            if (next == '|') return punct(TokenKind::pipe_pipe, 2);
             break;
     }
 
-    std::cerr << loc.filepath << ":" << loc.line << ":" << loc.col 
-              << ": error: unknown character '" << c << "'\n";
-    getNextChar();
-    return Token{loc, TokenKind::unk};
-}
\ No newline at end of file
+    error(start, std::string("unknown character '") + c + "'");
+    return punct(TokenKind::unk, 1);
+}
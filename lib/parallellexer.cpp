@@ -0,0 +1,188 @@
+#include "parallellexer.h"
+#include "scanner.h"
+#include <algorithm>
+#include <iostream>
+
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+
+namespace {
+// Below this, a chunk costs more to schedule than to lex.
+constexpr size_t minChunkSize = 64 * 1024;
+// Chunks per thread, so that a slow chunk does not hold up the others.
+constexpr unsigned chunksPerThread = 4;
+
+struct LexedChunk {
+    std::vector<Token> tokens;
+    std::vector<std::pair<size_t, Diagnostic>> diagnostics;  // local token index
+    IdentifierTable identifiers;  // until merged into the global table
+};
+
+void lexChunk(const SourceManager &SM, const SourceFile &file, size_t begin, size_t end,
+              bool last, IdentifierTable *identifiers, LexedChunk &chunk) {
+    TheLexer lexer{SM, file, begin, end};
+    std::vector<Diagnostic> messages;
+    lexer.setDiagnosticBuffer(&messages);
+    if (identifiers) lexer.setIdentifierTable(identifiers);
+    // Dense code runs about one token per 3 bytes. Reserving more than that
+    // only costs address space, since untouched pages are never faulted in.
+    chunk.tokens.reserve((end - begin) / 2 + 1);
+    while (true) {
+        Token tok = lexer.getNextToken();
+        for (Diagnostic &message : messages)
+            chunk.diagnostics.emplace_back(chunk.tokens.size(), std::move(message));
+        messages.clear();
+        // Only the last chunk's eof is the end of the file.
+        if (tok.kind == TokenKind::eof && !last) break;
+        chunk.tokens.push_back(tok);
+        if (tok.kind == TokenKind::eof) break;
+    }
+}
+}
+
+std::vector<size_t> findChunkBoundaries(llvm::StringRef buffer, size_t chunkSize) {
+    std::vector<size_t> boundaries{0};
+    const char *begin = buffer.data();
+    const char *end = begin + buffer.size();
+    const char *target = begin + std::min(chunkSize, buffer.size());
+    const char *p = begin;
+
+    // Strings and comments are skipped by the same rules as in
+    // TheLexer::getNextToken; every other byte is outside of them.
+    const char *special = scan::findStringOrCommentStart(p, end);
+    while (p < end) {
+        // Still valid after a chunk boundary, which never moves past it.
+        if (special < p) special = scan::findStringOrCommentStart(p, end);
+        if (special > target) {
+            const char *newline = scan::findNewline(std::max(p, target), special);
+            if (newline != special) {
+                p = newline + 1;
+                if (p == end) break;
+                boundaries.push_back(p - begin);
+                target = p + std::min<size_t>(chunkSize, end - p);
+                continue;
+            }
+        }
+        p = special;
+        if (p == end) break;
+
+        char c = *p;
+        char next = end - p > 1 ? p[1] : '\0';
+        if (c == '"' || c == '\'') {
+            const char *q = p + 1;
+            while (true) {
+                q = scan::findStringDelimiter(q, end, c);
+                if (q == end || *q == c) break;
+                q = end - q > 1 ? q + 2 : end;
+            }
+            p = q == end ? end : q + 1;
+        } else if (c == '#' || (c == '/' && next == '/')) {
+            p = scan::findNewline(p + 1, end);
+        } else if (c == '/' && next == '*') {
+            const char *close = scan::findBlockCommentEnd(p + 2, end);
+            p = close == end ? end : close + 2;
+        } else {
+            ++p;  // division
+        }
+    }
+    return boundaries;
+}
+
+TokenBuffer::TokenBuffer(const SourceManager &SM, const SourceFile &sourceFile, unsigned threads)
+    : TokenSource(SM, sourceFile) {
+    size_t fileSize = sourceFile.buffer.size();
+    size_t chunkSize = std::max(fileSize / (std::max(threads, 1u) * chunksPerThread), minChunkSize);
+    std::vector<size_t> boundaries = threads > 1
+        ? findChunkBoundaries(sourceFile.buffer, chunkSize)
+        : std::vector<size_t>{0};
+    boundaries.push_back(fileSize);
+
+    size_t numChunks = boundaries.size() - 1;
+    std::vector<LexedChunk> lexed(numChunks);
+    if (numChunks == 1) {
+        // Nothing to merge: intern straight into the global table.
+        lexChunk(SM, sourceFile, 0, fileSize, true, nullptr, lexed[0]);
+    } else {
+        llvm::DefaultThreadPool pool(llvm::hardware_concurrency(threads));
+        for (size_t i = 0; i < numChunks; ++i)
+            pool.async([&, i] {
+                lexChunk(SM, sourceFile, boundaries[i], boundaries[i + 1],
+                         i + 1 == numChunks, &lexed[i].identifiers, lexed[i]);
+            });
+        pool.wait();
+
+        // Move every chunk's identifiers into the global table, in chunk
+        // order and first-use order within a chunk. That hands out the same
+        // ids as the on-demand lexer, which sees them in the same order.
+        IdentifierTable &global = IdentifierTable::global();
+        for (size_t i = 0; i < numChunks; ++i) {
+            IdentifierTable &local = lexed[i].identifiers;
+            std::vector<Symbol> remap(local.size());
+            for (uint32_t id = 1; id < local.size(); ++id)
+                remap[id] = global.intern(local.getSpelling(Symbol{id}));
+            pool.async([&lexed, i, remap = std::move(remap)] {
+                for (Token &tok : lexed[i].tokens)
+                    if (tok.kind == TokenKind::identifier)
+                        tok.symbol = remap[tok.symbol.id];
+            });
+        }
+        pool.wait();
+    }
+
+    // Stitch the chunks together in file order. Chunks holding nothing but
+    // whitespace and comments have no tokens and are dropped.
+    for (LexedChunk &result : lexed) {
+        for (auto &[index, diag] : result.diagnostics)
+            diagnostics.push_back({numTokens + index, std::move(diag)});
+        if (result.tokens.empty()) continue;
+        chunkBegins.push_back(numTokens);
+        numTokens += result.tokens.size();
+        chunks.push_back(std::move(result.tokens));
+    }
+}
+
+Token TokenBuffer::read(ReadPosition &at, std::vector<Diagnostic> *diagnosticBuffer) const {
+    while (at.nextDiagnostic < diagnostics.size() &&
+           diagnostics[at.nextDiagnostic].tokenIndex <= at.position) {
+        const Diagnostic &diag = diagnostics[at.nextDiagnostic++].diag;
+        if (diagnosticBuffer)
+            diagnosticBuffer->push_back(diag);
+        else
+            std::cerr << formatDiagnostic(*SM, diag) << "\n";
+    }
+    const std::vector<Token> &tokens = chunks[at.chunk];
+    Token tok = tokens[at.index];
+    // Like the lexer, keep returning eof once the end is reached.
+    if (at.index + 1 < tokens.size()) {
+        ++at.index;
+        ++at.position;
+    } else if (at.chunk + 1 < chunks.size()) {
+        ++at.chunk;
+        at.index = 0;
+        ++at.position;
+    }
+    return tok;
+}
+
+size_t TokenBuffer::findToken(SourceLocation location) const {
+    auto chunk = std::partition_point(chunks.begin(), chunks.end(),
+        [location](const std::vector<Token> &tokens) { return !(location < tokens.front().location); });
+    size_t c = std::max<ptrdiff_t>(chunk - chunks.begin() - 1, 0);
+    auto tok = std::partition_point(chunks[c].begin(), chunks[c].end(),
+        [location](const Token &tok) { return tok.location < location; });
+    return chunkBegins[c] + (tok - chunks[c].begin());
+}
+
+TokenBuffer::Cursor::Cursor(const TokenBuffer &tokens, size_t start)
+    : TokenSource(*tokens.SM, *tokens.sourceFile), tokens(&tokens), lastIndex(start) {
+    const std::vector<size_t> &begins = tokens.chunkBegins;
+    begin.chunk = std::upper_bound(begins.begin(), begins.end(), start) - begins.begin() - 1;
+    begin.index = start - begins[begin.chunk];
+    begin.position = start;
+    begin.nextDiagnostic = std::partition_point(
+        tokens.diagnostics.begin(), tokens.diagnostics.end(),
+        [start](const PendingDiagnostic &pending) {
+            return start > 0 && pending.tokenIndex <= start;
+        }) - tokens.diagnostics.begin();
+    at = begin;
+}
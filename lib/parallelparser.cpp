@@ -0,0 +1,103 @@
+#include "parallelparser.h"
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "parser.h"
+
+namespace {
+// Below this, a range costs more to schedule than to parse.
+constexpr size_t minRangeSize = 16 * 1024;
+// Ranges per thread, so that a slow range does not hold up the others.
+constexpr unsigned rangesPerThread = 4;
+}
+
+std::vector<size_t> findFunctionBoundaries(const TokenBuffer &tokens, size_t rangeSize) {
+    std::vector<size_t> boundaries{0};
+    size_t index = 0, target = rangeSize;
+    unsigned depth = 0;
+    for (const std::vector<Token> &chunk : tokens.getChunks()) {
+        for (const Token &tok : chunk) {
+            if (tok.kind == TokenKind::lbrace) {
+                ++depth;
+            } else if (tok.kind == TokenKind::rbrace) {
+                if (depth > 0) --depth;
+            } else if (tok.kind == TokenKind::func && depth == 0 && index >= target) {
+                boundaries.push_back(index);
+                target = index + rangeSize;
+            }
+            ++index;
+        }
+    }
+    return boundaries;
+}
+
+ParallelParser::ParsedRange ParallelParser::parseRange(size_t start, size_t stop,
+                                                       ASTContext &rangeContext) const {
+    ParsedRange range;
+    TokenBuffer::Cursor cursor(tokens, start);
+    cursor.setDiagnosticBuffer(&range.diagnostics);
+    Parser parser(cursor, rangeContext);
+    parser.setDiagnosticBuffer(&range.diagnostics);
+    while (parser.peekToken().kind != TokenKind::eof && cursor.getLastIndex() < stop)
+        parser.parseTopLevelDecl(range.functions);
+    range.end = cursor.getLastIndex();
+    range.atEnd = parser.peekToken().kind == TokenKind::eof;
+    return range;
+}
+
+std::vector<FunctionDecl *> ParallelParser::parseProgram() {
+    constexpr size_t noStop = std::numeric_limits<size_t>::max();
+    size_t rangeSize = std::max(tokens.size() / (std::max(threads, 1u) * rangesPerThread),
+                                minRangeSize);
+    std::vector<size_t> starts = findFunctionBoundaries(tokens, rangeSize);
+    size_t numRanges = starts.size();
+    stats = Stats{};
+    stats.ranges = numRanges;
+
+    std::vector<ParsedRange> parsed(numRanges);
+    {
+        std::vector<ASTContext *> contexts;
+        for (size_t i = 0; i < numRanges; ++i)
+            contexts.push_back(&context.createSubContext());
+        llvm::DefaultThreadPool pool(llvm::hardware_concurrency(threads));
+        for (size_t i = 0; i < numRanges; ++i)
+            pool.async([&, i] {
+                parsed[i] = parseRange(starts[i], i + 1 < numRanges ? starts[i + 1] : noStop,
+                                       *contexts[i]);
+            });
+        pool.wait();
+    }
+
+    // Take the ranges that line up, in file order.
+    std::vector<FunctionDecl *> functions;
+    std::vector<Diagnostic> diagnostics;
+    size_t position = 0, next = 0;
+    while (true) {
+        while (next < numRanges && starts[next] < position) ++next;
+        ParsedRange reparsed;
+        ParsedRange *range;
+        if (next < numRanges && starts[next] == position) {
+            range = &parsed[next++];
+        } else {
+            ++stats.rangesReparsed;
+            reparsed = parseRange(position, next < numRanges ? starts[next] : noStop, context);
+            range = &reparsed;
+        }
+        functions.insert(functions.end(), range->functions.begin(), range->functions.end());
+        std::move(range->diagnostics.begin(), range->diagnostics.end(),
+                  std::back_inserter(diagnostics));
+        position = range->end;
+        if (range->atEnd) break;
+    }
+
+    if (diagnosticBuffer) {
+        std::move(diagnostics.begin(), diagnostics.end(), std::back_inserter(*diagnosticBuffer));
+    } else {
+        for (const Diagnostic &diag : diagnostics)
+            std::cerr << formatDiagnostic(tokens.getSourceManager(), diag) << "\n";
+    }
+    return functions;
+}
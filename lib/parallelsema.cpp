@@ -0,0 +1,68 @@
+#include "parallelsema.h"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <limits>
+
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "sema.h"
+
+namespace {
+// Below this, a run costs more to schedule than to check.
+constexpr size_t minRunSize = 64;
+// Runs per thread, so that a slow run does not hold up the others.
+constexpr unsigned runsPerThread = 4;
+}
+
+bool ParallelSema::resolve() {
+    SemanticAnalysis globals(SM);
+    for (FunctionDecl *function : functions) {
+        if (!globals.resolveFunctionSignature(*function))
+            return false;
+        globals.declareFunction(*function);
+    }
+
+    size_t runSize = std::max(functions.size() / (std::max(threads, 1u) * runsPerThread),
+                              minRunSize);
+    size_t numRuns = (functions.size() + runSize - 1) / runSize;
+    stats = Stats{};
+    stats.runs = numRuns;
+
+    std::vector<CheckedRun> runs(numRuns);
+    // Index of the earliest body known to fail; later ones need no checking.
+    std::atomic<size_t> firstFailure{std::numeric_limits<size_t>::max()};
+    {
+        llvm::DefaultThreadPool pool(llvm::hardware_concurrency(threads));
+        for (size_t r = 0; r < numRuns; ++r)
+            pool.async([&, r] {
+                CheckedRun &run = runs[r];
+                SemanticAnalysis sema(globals, SM);
+                sema.setDiagnosticBuffer(&run.diagnostics);
+                size_t end = std::min((r + 1) * runSize, functions.size());
+                for (size_t i = r * runSize; i < end; ++i) {
+                    if (i > firstFailure.load(std::memory_order_relaxed))
+                        return;
+                    if (!sema.resolveFunctionBody(*functions[i])) {
+                        run.ok = false;
+                        size_t seen = firstFailure.load(std::memory_order_relaxed);
+                        while (i < seen && !firstFailure.compare_exchange_weak(seen, i)) {}
+                        return;
+                    }
+                }
+            });
+        pool.wait();
+    }
+
+    for (const CheckedRun &run : runs) {
+        if (run.ok) continue;
+        for (const Diagnostic &diag : run.diagnostics)
+            std::cerr << formatDiagnostic(SM, diag) << "\n";
+        return false;
+    }
+
+    globals.setConstantFolding(foldingContext);
+    globals.foldConstants(functions);
+    stats.constantsFolded = globals.getFoldStats().folded;
+    return true;
+}
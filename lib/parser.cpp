@@ -1,15 +1,18 @@
 #include<iostream>
-#include <sstream>
 #include <initializer_list> 
 #include "utils.h"
 #include "parser.h"
+#include "llvm/ADT/SmallVector.h"
 
 void Parser::error(SourceLocation location, std::string_view message) {
-  const auto& [file, line, col] = location;
-  std::ostringstream oss;
-  oss << file << ':' << line << ':' << col << ": error: " << message;
-  diagnostics.push_back(oss.str());
-  std::cerr << oss.str() << "\n";
+  Diagnostic diag{location, std::string(message)};
+  if (diagnosticBuffer) {
+    diagnosticBuffer->push_back(std::move(diag));
+    return;
+  }
+  std::string formatted = formatDiagnostic(lexer->getSourceManager(), diag);
+  diagnostics.push_back(formatted);
+  std::cerr << formatted << "\n";
 }
 
 bool Parser::skipUntil(std::initializer_list<TokenKind> kinds){
@@ -24,22 +27,38 @@ bool Parser::skipUntil(std::initializer_list<TokenKind> kinds){
     }
 }
 
-std::unique_ptr<Expr> Parser::parseIdentifierExpr(){
+// Skips from a '{' past the matching '}'. Returns false if the file ends
+// first.
+bool Parser::skipBraces(){
+    unsigned depth = 0;
+    do {
+        if (nextToken.kind == TokenKind::eof)
+            return false;
+        if (nextToken.kind == TokenKind::lbrace)
+            ++depth;
+        else if (nextToken.kind == TokenKind::rbrace)
+            --depth;
+        skipToken();
+    } while (depth > 0);
+    return true;
+}
+
+Expr *Parser::parseIdentifierExpr(){
     SourceLocation location = nextToken.location;
-    std::string identifier = nextToken.value.value();
+    Symbol identifier = nextToken.symbol;
 
     skipToken();
 
     if (nextToken.kind != TokenKind::lpar)
-        return std::make_unique<DeclRefExpr>(location, identifier);
+        return context->create<DeclRefExpr>(location, identifier);
     
     skipToken(); // skip '('
     
-    std::vector<std::unique_ptr<Expr>> arguments;
+    llvm::SmallVector<Expr *, 8> arguments;
     while(nextToken.kind != TokenKind::rpar && nextToken.kind != TokenKind::eof){
         
-        if(std::unique_ptr<Expr> expr = parseExpr()){
-            arguments.push_back(std::move(expr));
+        if(Expr *expr = parseExpr()){
+            arguments.push_back(expr);
         } else {
             if (!skipUntil({TokenKind::comma, TokenKind::rpar}))
                 break;
@@ -61,10 +80,10 @@ std::unique_ptr<Expr> Parser::parseIdentifierExpr(){
     else {
         error(location, "expected ')' to close argument list");
     }
-    return std::make_unique<CallExpr>(location,std::move(identifier), std::move(arguments));
+    return context->create<CallExpr>(location, identifier, context->copyArray<Expr *>(arguments));
 }
 
-std::unique_ptr<Expr> Parser::parsePrintExpr(){
+Expr *Parser::parsePrintExpr(){
     SourceLocation location = nextToken.location;
     skipToken(); // skip 'print'
     
@@ -74,11 +93,11 @@ std::unique_ptr<Expr> Parser::parsePrintExpr(){
     }
     skipToken();
     
-    std::vector<std::unique_ptr<Expr>> arguments;
+    llvm::SmallVector<Expr *, 8> arguments;
     while(nextToken.kind != TokenKind::rpar && nextToken.kind != TokenKind::eof){
         
-        if(std::unique_ptr<Expr> expr = parseExpr()){
-            arguments.push_back(std::move(expr));
+        if(Expr *expr = parseExpr()){
+            arguments.push_back(expr);
         } else {
             if (!skipUntil({TokenKind::comma, TokenKind::rpar}))
                 break;
@@ -106,27 +125,28 @@ std::unique_ptr<Expr> Parser::parsePrintExpr(){
         return nullptr;
     }
     
-    return std::make_unique<PrintExpr>(std::move(location), std::move(arguments));
+    return context->create<PrintExpr>(location, context->copyArray<Expr *>(arguments));
 }
 
-std::unique_ptr<Expr> Parser::parseNumberExpr() {
-    std::string val = nextToken.value.value();
-    Type t = Type::INT;
-    if (val.find('.') != std::string::npos) {
-        t = Type::FLOAT;
-    }
-    auto literal = std::make_unique<NumberLiteral>(nextToken.location, val, t);
+Expr *Parser::parseNumberExpr() {
+    NumberLiteral *literal;
+    if (nextToken.kind == TokenKind::float_literal)
+        literal = context->create<NumberLiteral>(nextToken.location, nextToken.floatValue);
+    else
+        literal = context->create<NumberLiteral>(nextToken.location, nextToken.intValue);
     skipToken();
     return literal;
 }
 
-std::unique_ptr<Expr> Parser::parseStringExpr() {
-    auto strliteral = std::make_unique<StringLiteral>(nextToken.location, nextToken.value.value());
+Expr *Parser::parseStringExpr() {
+    std::string storage;
+    llvm::StringRef value = lexer->getStringValue(nextToken, storage);
+    auto strliteral = context->create<StringLiteral>(nextToken.location, context->copyString(value));
     skipToken();
     return strliteral;
 }
 
-std::unique_ptr<Expr> Parser::parseParenExpr() {
+Expr *Parser::parseParenExpr() {
     skipToken();
     auto v = parseExpr();
     if(!v)
@@ -139,11 +159,11 @@ std::unique_ptr<Expr> Parser::parseParenExpr() {
     return v;
 }
 
-std::unique_ptr<Stmt> Parser::parseReturnStmt(){
+Stmt *Parser::parseReturnStmt(){
     SourceLocation location = nextToken.location;
     skipToken(); // skip return token
     
-    std::unique_ptr<Expr> exp;
+    Expr *exp = nullptr;
     if (nextToken.kind != TokenKind::semi) {
         exp = parseExpr();
         if (!exp) {
@@ -157,18 +177,20 @@ std::unique_ptr<Stmt> Parser::parseReturnStmt(){
         return nullptr; 
     }
     skipToken();
-    return std::make_unique<ReturnStmt>(location, std::move(exp));
+    return context->create<ReturnStmt>(location, exp);
 } 
 
 
-std::unique_ptr<VariableDecl> Parser::parseVariableDecl(){
+VariableDecl *Parser::parseVariableDecl(){
     SourceLocation location = nextToken.location;
-    std::string typeName;
+    llvm::StringRef typeName;
     
     if (nextToken.kind == TokenKind::cf_int) {
         typeName = "int";
     } else if (nextToken.kind == TokenKind::cf_float) {
         typeName = "float";
+    } else if (nextToken.kind == TokenKind::cf_bool) {
+        typeName = "bool";
     } else {
         error(nextToken.location, "expected type name in variable declaration");
         return nullptr;
@@ -180,10 +202,10 @@ std::unique_ptr<VariableDecl> Parser::parseVariableDecl(){
         return nullptr;
     }
     
-    std::string varName = nextToken.value.value();
+    Symbol varName = nextToken.symbol;
     skipToken(); // skip identifier
     
-    std::unique_ptr<Expr> initializer;
+    Expr *initializer = nullptr;
     
     // Check for optional initializer
     if (nextToken.kind == TokenKind::equal) {
@@ -195,7 +217,7 @@ std::unique_ptr<VariableDecl> Parser::parseVariableDecl(){
         }
     }
     
-    return std::make_unique<VariableDecl>(location, varName, typeName, std::move(initializer));
+    return context->create<VariableDecl>(location, varName, typeName, initializer);
 }
 
 
@@ -224,20 +246,21 @@ int Parser::getTokPrecedence() {
     }
 }
 
-std::unique_ptr<Expr> Parser::parseBooleanExpr() {
+Expr *Parser::parseBooleanExpr() {
     bool value = (nextToken.kind == TokenKind::cf_true);
-    auto literal = std::make_unique<BooleanLiteral>(nextToken.location, value);
+    auto literal = context->create<BooleanLiteral>(nextToken.location, value);
     skipToken();
     return literal;
 }
 
-std::unique_ptr<Expr> Parser::parsePrimaryExpr() {
+Expr *Parser::parsePrimaryExpr() {
     switch (nextToken.kind){
         default:
             error(nextToken.location, "expected expression");
             skipToken();
             return nullptr; 
-        case TokenKind::number:
+        case TokenKind::int_literal:
+        case TokenKind::float_literal:
             return parseNumberExpr();
         case TokenKind::string_literal:
             return parseStringExpr();
@@ -253,7 +276,7 @@ std::unique_ptr<Expr> Parser::parsePrimaryExpr() {
     }
 }
 
-std::unique_ptr<Expr> Parser::parseBinaryExpr(int exprPrec, std::unique_ptr<Expr> lhs) {
+Expr *Parser::parseBinaryExpr(int exprPrec, Expr *lhs) {
     while (true) {
         int tokPrec = getTokPrecedence();
         
@@ -270,24 +293,24 @@ std::unique_ptr<Expr> Parser::parseBinaryExpr(int exprPrec, std::unique_ptr<Expr
         
         int nextPrec = getTokPrecedence();
         if (tokPrec < nextPrec) {
-            rhs = parseBinaryExpr(tokPrec + 1, std::move(rhs));
+            rhs = parseBinaryExpr(tokPrec + 1, rhs);
             if (!rhs)
                 return nullptr;
         }
         
-        lhs = std::make_unique<BinaryExpr>(opLoc, std::move(lhs), binOp, std::move(rhs));
+        lhs = context->create<BinaryExpr>(opLoc, lhs, binOp, rhs);
     }
 }
 
-std::unique_ptr<Expr> Parser::parseExpr(){
+Expr *Parser::parseExpr(){
     auto lhs = parsePrimaryExpr();
     if (!lhs)
         return nullptr;
     
-    if (auto declRef = dynamic_cast<DeclRefExpr*>(lhs.get())) {
+    if (auto *declRef = llvm::dyn_cast<DeclRefExpr>(lhs)) {
         if (nextToken.kind == TokenKind::equal) {
             SourceLocation assignLoc = nextToken.location;
-            std::string target = declRef->identifier;
+            Symbol target = declRef->identifier;
             skipToken(); // skip '='
             
             auto rhs = parseExpr();
@@ -296,15 +319,15 @@ std::unique_ptr<Expr> Parser::parseExpr(){
                 return nullptr;
             }
             
-            return std::make_unique<AssignmentExpr>(assignLoc, target, std::move(rhs));
+            return context->create<AssignmentExpr>(assignLoc, target, rhs);
         }
     }
     
-    return parseBinaryExpr(0, std::move(lhs));
+    return parseBinaryExpr(0, lhs);
 }
 
 
-std::unique_ptr<Stmt> Parser::parseIfStmt() {
+Stmt *Parser::parseIfStmt() {
     SourceLocation location = nextToken.location;
     skipToken(); // skip 'if'
     
@@ -336,7 +359,7 @@ std::unique_ptr<Stmt> Parser::parseIfStmt() {
         return nullptr;
     }
     
-    std::unique_ptr<Block> elseBlock;
+    Block *elseBlock = nullptr;
     if (nextToken.kind == TokenKind::cf_else) {
         skipToken(); // skip 'else'
         
@@ -351,10 +374,10 @@ std::unique_ptr<Stmt> Parser::parseIfStmt() {
         }
     }
     
-    return std::make_unique<IfStmt>(location, std::move(condition), std::move(thenBlock), std::move(elseBlock));
+    return context->create<IfStmt>(location, condition, thenBlock, elseBlock);
 }
 
-std::unique_ptr<Stmt> Parser::parseWhileStmt() {
+Stmt *Parser::parseWhileStmt() {
     SourceLocation location = nextToken.location;
     skipToken(); // skip 'while'
     
@@ -386,10 +409,10 @@ std::unique_ptr<Stmt> Parser::parseWhileStmt() {
         return nullptr;
     }
     
-    return std::make_unique<WhileStmt>(location, std::move(condition), std::move(body));
+    return context->create<WhileStmt>(location, condition, body);
 }
 
-std::unique_ptr<Stmt> Parser::parseStmt() {
+Stmt *Parser::parseStmt() {
     if (nextToken.kind == TokenKind::cf_return)
             return parseReturnStmt();
     
@@ -399,7 +422,8 @@ std::unique_ptr<Stmt> Parser::parseStmt() {
     if (nextToken.kind == TokenKind::cf_while)
             return parseWhileStmt();
     
-    if (nextToken.kind == TokenKind::cf_int || nextToken.kind == TokenKind::cf_float) {
+    if (nextToken.kind == TokenKind::cf_int || nextToken.kind == TokenKind::cf_float ||
+        nextToken.kind == TokenKind::cf_bool) {
         auto varDecl = parseVariableDecl();
         if (!varDecl) {
             if (!skipUntil({TokenKind::semi, TokenKind::rbrace}))
@@ -437,16 +461,16 @@ std::unique_ptr<Stmt> Parser::parseStmt() {
     return expr;
 }
 
-std::unique_ptr<Block> Parser::parseBlock() {
+Block *Parser::parseBlock() {
     SourceLocation location = nextToken.location;
     skipToken(); // skip '{'
     
-    std::vector<std::unique_ptr<Stmt>> statements;
+    llvm::SmallVector<Stmt *, 16> statements;
 
     while (nextToken.kind != TokenKind::rbrace && nextToken.kind != TokenKind::eof) {
         auto stmt = parseStmt();
         if (stmt) {
-            statements.push_back(std::move(stmt));
+            statements.push_back(stmt);
         } else {
             // Always advance at least once on failure
             if (nextToken.kind != TokenKind::rbrace && nextToken.kind != TokenKind::eof)
@@ -460,12 +484,12 @@ std::unique_ptr<Block> Parser::parseBlock() {
     }
 
     skipToken(); // skips '}' token
-    return std::make_unique<Block>(location, std::move(statements));
+    return context->create<Block>(location, context->copyArray<Stmt *>(statements));
 }
 
-std::unique_ptr<ParamDecl> Parser::parseParams(){
+ParamDecl *Parser::parseParams(){
     SourceLocation paramloc = nextToken.location;
-    std::string paramname = nextToken.value.value();
+    Symbol paramname = nextToken.symbol;
     skipToken(); // skips 'pameter identifier' token
     
     if(nextToken.kind != TokenKind::colon){
@@ -477,21 +501,23 @@ std::unique_ptr<ParamDecl> Parser::parseParams(){
     if(nextToken.kind != TokenKind::identifier && 
        nextToken.kind != TokenKind::cf_int && 
        nextToken.kind != TokenKind::cf_float &&
+       nextToken.kind != TokenKind::cf_bool &&
        nextToken.kind != TokenKind::cf_void){ // void might not be valid for params but good for completeness
         error(nextToken.location, "expected type name after ':'");
         return nullptr;
     }
-    std::string typname;
-    if (nextToken.kind == TokenKind::identifier) typname = nextToken.value.value();
+    llvm::StringRef typname;
+    if (nextToken.kind == TokenKind::identifier) typname = context->copyString(lexer->getSpelling(nextToken));
     else if (nextToken.kind == TokenKind::cf_int) typname = "int";
     else if (nextToken.kind == TokenKind::cf_float) typname = "float";
+    else if (nextToken.kind == TokenKind::cf_bool) typname = "bool";
     else if (nextToken.kind == TokenKind::cf_void) typname = "void";
     
     skipToken();// skips 'parameter type' token
-    return std::make_unique<ParamDecl>(paramloc, paramname, typname);
+    return context->create<ParamDecl>(paramloc, paramname, typname);
 }
 
-std::unique_ptr<FunctionDecl> Parser::parseFunction() {
+FunctionDecl *Parser::parseFunction() {
     SourceLocation funcLoc = nextToken.location;
     skipToken(); // skips 'func' token
 
@@ -499,7 +525,7 @@ std::unique_ptr<FunctionDecl> Parser::parseFunction() {
         error(nextToken.location, "expected function name after 'func'");
         return nullptr;
     }
-    std::string funcName = nextToken.value.value();
+    Symbol funcName = nextToken.symbol;
     skipToken(); // skips func name token
 
     if (nextToken.kind != TokenKind::lpar){
@@ -508,7 +534,7 @@ std::unique_ptr<FunctionDecl> Parser::parseFunction() {
     }
     skipToken(); // skips '(' token
     
-    std::vector<std::unique_ptr<ParamDecl>> params;
+    llvm::SmallVector<ParamDecl *, 8> params;
 
     while (nextToken.kind != TokenKind::rpar && nextToken.kind != TokenKind::eof) {
         if (nextToken.kind != TokenKind::identifier){
@@ -521,7 +547,7 @@ std::unique_ptr<FunctionDecl> Parser::parseFunction() {
         }
         
         if (auto param = parseParams())
-            params.push_back(std::move(param));
+            params.push_back(param);
         else {
             if (!skipUntil({TokenKind::comma, TokenKind::rpar}))
                 break;
@@ -544,14 +570,16 @@ std::unique_ptr<FunctionDecl> Parser::parseFunction() {
     if (nextToken.kind != TokenKind::identifier && 
         nextToken.kind != TokenKind::cf_int && 
         nextToken.kind != TokenKind::cf_float && 
+        nextToken.kind != TokenKind::cf_bool && 
         nextToken.kind != TokenKind::cf_void){
         error(nextToken.location, "expected return type after ':'");
         return nullptr;
     }
-    std::string funcType;
-    if (nextToken.kind == TokenKind::identifier) funcType = nextToken.value.value();
+    llvm::StringRef funcType;
+    if (nextToken.kind == TokenKind::identifier) funcType = context->copyString(lexer->getSpelling(nextToken));
     else if (nextToken.kind == TokenKind::cf_int) funcType = "int";
     else if (nextToken.kind == TokenKind::cf_float) funcType = "float";
+    else if (nextToken.kind == TokenKind::cf_bool) funcType = "bool";
     else if (nextToken.kind == TokenKind::cf_void) funcType = "void";
 
     skipToken(); // skips func type token
@@ -560,30 +588,42 @@ std::unique_ptr<FunctionDecl> Parser::parseFunction() {
         error(nextToken.location, "expected '{' to begin function body");
         return nullptr;
     }
+    if (skipFunctionBodies) {
+        SourceLocation bodyLoc = nextToken.location;
+        if (!skipBraces()) {
+            error(bodyLoc, "expected '}' at the end of block");
+            return nullptr;
+        }
+        return context->create<FunctionDecl>(
+            funcLoc, funcName, funcType, context->copyArray<ParamDecl *>(params), nullptr);
+    }
     auto body = parseBlock();
     if (!body)
         return nullptr;
 
-    return std::make_unique<FunctionDecl>(
-        funcLoc, funcName, funcType, std::move(params), std::move(body));
+    return context->create<FunctionDecl>(
+        funcLoc, funcName, funcType, context->copyArray<ParamDecl *>(params), body);
 }
 
-std::vector<std::unique_ptr<FunctionDecl>> Parser::parseProgram(){
-    std::vector<std::unique_ptr<FunctionDecl>> functions;
-
-    while(nextToken.kind != TokenKind::eof){
-        if(nextToken.kind != TokenKind::func){
-            error(nextToken.location, "only 'func' declarations allowed at top level");
-            if(!skipUntil({TokenKind::func, TokenKind::eof})) 
-                skipToken(); 
-            continue;
-        }
-        if (auto func = parseFunction()){
-            functions.push_back(std::move(func));
-        } else {
-            if(!skipUntil({TokenKind::func, TokenKind::eof})) 
-                skipToken(); 
-        }
+void Parser::parseTopLevelDecl(std::vector<FunctionDecl *> &functions){
+    if(nextToken.kind != TokenKind::func){
+        error(nextToken.location, "only 'func' declarations allowed at top level");
+        if(!skipUntil({TokenKind::func, TokenKind::eof})) 
+            skipToken(); 
+        return;
+    }
+    if (auto func = parseFunction()){
+        functions.push_back(func);
+    } else {
+        if(!skipUntil({TokenKind::func, TokenKind::eof})) 
+            skipToken(); 
     }
+}
+
+std::vector<FunctionDecl *> Parser::parseProgram(){
+    std::vector<FunctionDecl *> functions;
+
+    while(nextToken.kind != TokenKind::eof)
+        parseTopLevelDecl(functions);
     return functions;
-}
\ No newline at end of file
+}
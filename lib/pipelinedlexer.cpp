@@ -0,0 +1,103 @@
+#include "pipelinedlexer.h"
+#include <iostream>
+
+// Waits for the other thread to move its counter. Spins briefly, as the
+// other side usually catches up within a batch, then sleeps so that a
+// parser waiting on a slow lexer (or the reverse) does not hold a core.
+template <typename Ready>
+void PipelinedLexer::waitUntil(Ready ready) {
+    for (unsigned spins = 0; spins < 64; ++spins) {
+        if (ready()) return;
+    }
+    std::unique_lock<std::mutex> lock(waitMutex);
+    counterMoved.wait(lock, ready);
+}
+
+// Called after moving a counter. Taking the mutex orders the move before
+// the waiter's last check of `ready` or after its sleep begins, so the
+// wakeup cannot be lost.
+void PipelinedLexer::wakeWaiter() {
+    { std::lock_guard<std::mutex> lock(waitMutex); }
+    counterMoved.notify_one();
+}
+
+PipelinedLexer::PipelinedLexer(const SourceManager &SM, const SourceFile &sourceFile)
+    : TokenSource(SM, sourceFile), lexer(SM, sourceFile),
+      ring(std::make_unique<Batch[]>(ringSize)) {
+    start();
+}
+
+void PipelinedLexer::start() {
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    stopRequested.store(false, std::memory_order_relaxed);
+    current = nullptr;
+    index = nextDiagnostic = 0;
+    producer = std::thread([this] { produce(); });
+}
+
+void PipelinedLexer::stop() {
+    if (!producer.joinable()) return;
+    stopRequested.store(true, std::memory_order_relaxed);
+    wakeWaiter();
+    producer.join();
+}
+
+void PipelinedLexer::produce() {
+    std::vector<Diagnostic> messages;
+    lexer.setDiagnosticBuffer(&messages);
+    size_t published = head.load(std::memory_order_relaxed);
+    bool done = false;
+    while (!done) {
+        // Backpressure: wait until the parser has released a slot.
+        waitUntil([&] {
+            return published - tail.load(std::memory_order_acquire) < ringSize ||
+                   stopRequested.load(std::memory_order_relaxed);
+        });
+        if (stopRequested.load(std::memory_order_relaxed)) return;
+
+        Batch &batch = ring[published % ringSize];
+        batch.count = 0;
+        batch.diagnostics.clear();
+        while (batch.count < batchSize) {
+            Token tok = lexer.getNextToken();
+            for (Diagnostic &message : messages)
+                batch.diagnostics.emplace_back(batch.count, std::move(message));
+            messages.clear();
+            batch.tokens[batch.count++] = tok;
+            if (tok.kind == TokenKind::eof) {
+                done = true;
+                break;
+            }
+        }
+        head.store(++published, std::memory_order_release);
+        wakeWaiter();
+    }
+}
+
+Token PipelinedLexer::getNextToken() {
+    if (!current || index == current->count) {
+        size_t next = tail.load(std::memory_order_relaxed);
+        if (current) {
+            tail.store(++next, std::memory_order_release);
+            wakeWaiter();
+        }
+        waitUntil([&] { return head.load(std::memory_order_acquire) != next; });
+        current = &ring[next % ringSize];
+        index = nextDiagnostic = 0;
+    }
+
+    while (nextDiagnostic < current->diagnostics.size() &&
+           current->diagnostics[nextDiagnostic].first <= index)
+        std::cerr << formatDiagnostic(*SM, current->diagnostics[nextDiagnostic++].second) << "\n";
+    Token tok = current->tokens[index];
+    // Like the lexer, keep returning eof once the end is reached.
+    if (tok.kind != TokenKind::eof) ++index;
+    return tok;
+}
+
+void PipelinedLexer::rewind() {
+    stop();
+    lexer.rewind();
+    start();
+}
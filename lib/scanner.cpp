@@ -0,0 +1,342 @@
+#include "scanner.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace scan {
+namespace {
+
+bool isWhitespace(char c) {
+    return c == ' ' || (static_cast<unsigned char>(c - '\t') <= '\r' - '\t');
+}
+
+bool isIdentifierChar(char c) {
+    return static_cast<unsigned char>((c | 0x20) - 'a') <= 'z' - 'a' ||
+           static_cast<unsigned char>(c - '0') <= 9 || c == '_';
+}
+
+/*-------------------- Scalar --------------------*/
+
+const char *skipWhitespaceScalar(const char *p, const char *end) {
+    while (p != end && isWhitespace(*p)) ++p;
+    return p;
+}
+
+const char *findNewlineScalar(const char *p, const char *end) {
+    while (p != end && *p != '\n') ++p;
+    return p;
+}
+
+const char *findBlockCommentEndScalar(const char *p, const char *end) {
+    for (; end - p >= 2; ++p) {
+        if (p[0] == '*' && p[1] == '/') return p;
+    }
+    return end;
+}
+
+const char *skipIdentifierCharsScalar(const char *p, const char *end) {
+    while (p != end && isIdentifierChar(*p)) ++p;
+    return p;
+}
+
+const char *findStringDelimiterScalar(const char *p, const char *end, char quote) {
+    if (quote == '"') {
+        while (p != end && *p != '"' && *p != '\\') ++p;
+    } else {
+        while (p != end && *p != quote) ++p;
+    }
+    return p;
+}
+
+bool opensStringOrComment(char c) {
+    return c == '"' || c == '\'' || c == '#' || c == '/';
+}
+
+const char *findStringOrCommentStartScalar(const char *p, const char *end) {
+    while (p != end && !opensStringOrComment(*p)) ++p;
+    return p;
+}
+
+#ifdef SCAN_X86
+
+/*-------------------- SSE2 (16 bytes per step) --------------------*/
+// Unsigned "x <= limit" on bytes is spelled min(x, limit) == x, since SSE2
+// and AVX2 only have signed byte comparisons.
+
+__attribute__((target("sse2")))
+const char *skipWhitespaceSSE2(const char *p, const char *end) {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i range = _mm_set1_epi8('\r' - '\t');
+    for (; end - p >= 16; p += 16) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        __m128i t = _mm_sub_epi8(c, tab);
+        __m128i ws = _mm_or_si128(_mm_cmpeq_epi8(c, space),
+                                  _mm_cmpeq_epi8(_mm_min_epu8(t, range), t));
+        unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(ws)) & 0xFFFFu;
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return skipWhitespaceScalar(p, end);
+}
+
+__attribute__((target("sse2")))
+const char *findNewlineSSE2(const char *p, const char *end) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; end - p >= 16; p += 16) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(c, newline)));
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return findNewlineScalar(p, end);
+}
+
+__attribute__((target("sse2")))
+const char *findBlockCommentEndSSE2(const char *p, const char *end) {
+    const __m128i star = _mm_set1_epi8('*');
+    const __m128i slash = _mm_set1_epi8('/');
+    // Each step also reads the byte after the block, for the '/'.
+    for (; end - p >= 17; p += 16) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 1));
+        __m128i hit = _mm_and_si128(_mm_cmpeq_epi8(c, star), _mm_cmpeq_epi8(next, slash));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return findBlockCommentEndScalar(p, end);
+}
+
+__attribute__((target("sse2")))
+const char *skipIdentifierCharsSSE2(const char *p, const char *end) {
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    const __m128i lowerA = _mm_set1_epi8('a');
+    const __m128i alphaRange = _mm_set1_epi8('z' - 'a');
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i digitRange = _mm_set1_epi8(9);
+    const __m128i underscore = _mm_set1_epi8('_');
+    for (; end - p >= 16; p += 16) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        __m128i a = _mm_sub_epi8(_mm_or_si128(c, caseBit), lowerA);
+        __m128i d = _mm_sub_epi8(c, zero);
+        __m128i ident = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(a, alphaRange), a),
+                         _mm_cmpeq_epi8(_mm_min_epu8(d, digitRange), d)),
+            _mm_cmpeq_epi8(c, underscore));
+        unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(ident)) & 0xFFFFu;
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return skipIdentifierCharsScalar(p, end);
+}
+
+__attribute__((target("sse2")))
+const char *findStringDelimiterSSE2(const char *p, const char *end, char quote) {
+    const __m128i q = _mm_set1_epi8(quote);
+    const __m128i escape = _mm_set1_epi8(quote == '"' ? '\\' : quote);
+    for (; end - p >= 16; p += 16) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(c, q), _mm_cmpeq_epi8(c, escape));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return findStringDelimiterScalar(p, end, quote);
+}
+
+__attribute__((target("sse2")))
+const char *findStringOrCommentStartSSE2(const char *p, const char *end) {
+    const __m128i dquote = _mm_set1_epi8('"');
+    const __m128i squote = _mm_set1_epi8('\'');
+    const __m128i hash = _mm_set1_epi8('#');
+    const __m128i slash = _mm_set1_epi8('/');
+    for (; end - p >= 16; p += 16) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        __m128i hit = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(c, dquote), _mm_cmpeq_epi8(c, squote)),
+            _mm_or_si128(_mm_cmpeq_epi8(c, hash), _mm_cmpeq_epi8(c, slash)));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return findStringOrCommentStartScalar(p, end);
+}
+
+/*-------------------- AVX2 (32 bytes per step) --------------------*/
+
+__attribute__((target("avx2")))
+const char *skipWhitespaceAVX2(const char *p, const char *end) {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i range = _mm256_set1_epi8('\r' - '\t');
+    for (; end - p >= 32; p += 32) {
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i t = _mm256_sub_epi8(c, tab);
+        __m256i ws = _mm256_or_si256(_mm256_cmpeq_epi8(c, space),
+                                     _mm256_cmpeq_epi8(_mm256_min_epu8(t, range), t));
+        unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(ws));
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return skipWhitespaceSSE2(p, end);
+}
+
+__attribute__((target("avx2")))
+const char *findNewlineAVX2(const char *p, const char *end) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    for (; end - p >= 32; p += 32) {
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, newline)));
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return findNewlineSSE2(p, end);
+}
+
+__attribute__((target("avx2")))
+const char *findBlockCommentEndAVX2(const char *p, const char *end) {
+    const __m256i star = _mm256_set1_epi8('*');
+    const __m256i slash = _mm256_set1_epi8('/');
+    for (; end - p >= 33; p += 32) {
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i next = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 1));
+        __m256i hit = _mm256_and_si256(_mm256_cmpeq_epi8(c, star), _mm256_cmpeq_epi8(next, slash));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return findBlockCommentEndSSE2(p, end);
+}
+
+__attribute__((target("avx2")))
+const char *skipIdentifierCharsAVX2(const char *p, const char *end) {
+    const __m256i caseBit = _mm256_set1_epi8(0x20);
+    const __m256i lowerA = _mm256_set1_epi8('a');
+    const __m256i alphaRange = _mm256_set1_epi8('z' - 'a');
+    const __m256i zero = _mm256_set1_epi8('0');
+    const __m256i digitRange = _mm256_set1_epi8(9);
+    const __m256i underscore = _mm256_set1_epi8('_');
+    for (; end - p >= 32; p += 32) {
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i a = _mm256_sub_epi8(_mm256_or_si256(c, caseBit), lowerA);
+        __m256i d = _mm256_sub_epi8(c, zero);
+        __m256i ident = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(a, alphaRange), a),
+                            _mm256_cmpeq_epi8(_mm256_min_epu8(d, digitRange), d)),
+            _mm256_cmpeq_epi8(c, underscore));
+        unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(ident));
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return skipIdentifierCharsSSE2(p, end);
+}
+
+__attribute__((target("avx2")))
+const char *findStringDelimiterAVX2(const char *p, const char *end, char quote) {
+    const __m256i q = _mm256_set1_epi8(quote);
+    const __m256i escape = _mm256_set1_epi8(quote == '"' ? '\\' : quote);
+    for (; end - p >= 32; p += 32) {
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i hit = _mm256_or_si256(_mm256_cmpeq_epi8(c, q), _mm256_cmpeq_epi8(c, escape));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return findStringDelimiterSSE2(p, end, quote);
+}
+
+__attribute__((target("avx2")))
+const char *findStringOrCommentStartAVX2(const char *p, const char *end) {
+    const __m256i dquote = _mm256_set1_epi8('"');
+    const __m256i squote = _mm256_set1_epi8('\'');
+    const __m256i hash = _mm256_set1_epi8('#');
+    const __m256i slash = _mm256_set1_epi8('/');
+    for (; end - p >= 32; p += 32) {
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i hit = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(c, dquote), _mm256_cmpeq_epi8(c, squote)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(c, hash), _mm256_cmpeq_epi8(c, slash)));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return findStringOrCommentStartSSE2(p, end);
+}
+
+#endif // SCAN_X86
+
+/*-------------------- Dispatch --------------------*/
+
+struct Scanners {
+    ISA isa;
+    const char *(*skipWhitespace)(const char *, const char *);
+    const char *(*findNewline)(const char *, const char *);
+    const char *(*findBlockCommentEnd)(const char *, const char *);
+    const char *(*skipIdentifierChars)(const char *, const char *);
+    const char *(*findStringDelimiter)(const char *, const char *, char);
+    const char *(*findStringOrCommentStart)(const char *, const char *);
+};
+
+const Scanners scalarScanners = {
+    ISA::Scalar, skipWhitespaceScalar, findNewlineScalar, findBlockCommentEndScalar,
+    skipIdentifierCharsScalar, findStringDelimiterScalar, findStringOrCommentStartScalar};
+
+#ifdef SCAN_X86
+const Scanners sse2Scanners = {
+    ISA::SSE2, skipWhitespaceSSE2, findNewlineSSE2, findBlockCommentEndSSE2,
+    skipIdentifierCharsSSE2, findStringDelimiterSSE2, findStringOrCommentStartSSE2};
+
+const Scanners avx2Scanners = {
+    ISA::AVX2, skipWhitespaceAVX2, findNewlineAVX2, findBlockCommentEndAVX2,
+    skipIdentifierCharsAVX2, findStringDelimiterAVX2, findStringOrCommentStartAVX2};
+#endif
+
+const Scanners *pickScanners(ISA isa) {
+#ifdef SCAN_X86
+    __builtin_cpu_init();
+    if ((isa == ISA::Auto || isa == ISA::AVX2) && __builtin_cpu_supports("avx2"))
+        return &avx2Scanners;
+    if (isa != ISA::Scalar && __builtin_cpu_supports("sse2"))
+        return &sse2Scanners;
+#endif
+    return &scalarScanners;
+}
+
+// Chosen during static initialization, before any lexer can run.
+const Scanners *active = pickScanners(ISA::Auto);
+
+} // namespace
+
+ISA selectISA(ISA isa) {
+    active = pickScanners(isa);
+    return active->isa;
+}
+
+ISA activeISA() { return active->isa; }
+
+const char *isaName(ISA isa) {
+    switch (isa) {
+        case ISA::Auto: return "auto";
+        case ISA::Scalar: return "scalar";
+        case ISA::SSE2: return "sse2";
+        case ISA::AVX2: return "avx2";
+    }
+    return "unknown";
+}
+
+const char *skipWhitespace(const char *p, const char *end) {
+    return active->skipWhitespace(p, end);
+}
+
+const char *findNewline(const char *p, const char *end) {
+    return active->findNewline(p, end);
+}
+
+const char *findBlockCommentEnd(const char *p, const char *end) {
+    return active->findBlockCommentEnd(p, end);
+}
+
+const char *skipIdentifierChars(const char *p, const char *end) {
+    return active->skipIdentifierChars(p, end);
+}
+
+const char *findStringDelimiter(const char *p, const char *end, char quote) {
+    return active->findStringDelimiter(p, end, quote);
+}
+
+const char *findStringOrCommentStart(const char *p, const char *end) {
+    return active->findStringOrCommentStart(p, end);
+}
+
+}
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <limits>
+
+#include "llvm/Support/ErrorHandling.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "sourcemanager.h"
+
+namespace {
+// Appends the offset following every '\n' in `buffer` to `lineStarts`.
+void scanNewlines(llvm::StringRef buffer, std::vector<uint32_t> &lineStarts) {
+    const char *begin = buffer.data();
+    const char *p = begin;
+    const char *end = begin + buffer.size();
+#ifdef __SSE2__
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; end - p >= 16; p += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline));
+        while (mask) {
+            lineStarts.push_back(static_cast<uint32_t>(p - begin + __builtin_ctz(mask) + 1));
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; p != end; ++p) {
+        if (*p == '\n')
+            lineStarts.push_back(static_cast<uint32_t>(p - begin + 1));
+    }
+}
+}
+
+std::pair<unsigned, unsigned> SourceFile::getLineAndColumn(size_t offset) const {
+    std::call_once(lineStartsBuilt, [this] {
+        lineStarts.reserve(buffer.size() / 32 + 1);
+        lineStarts.push_back(0);
+        scanNewlines(buffer, lineStarts);
+    });
+    auto it = std::upper_bound(lineStarts.begin(), lineStarts.end(), offset);
+    unsigned line = static_cast<unsigned>(it - lineStarts.begin());
+    unsigned col = static_cast<unsigned>(offset - *(it - 1)) + 1;
+    return {line, col};
+}
+
+const SourceFile &SourceManager::addFile(std::string path, std::unique_ptr<llvm::MemoryBuffer> buffer) {
+    // Reserve one extra location per file so that its end-of-file position
+    // still belongs to it.
+    uint64_t size = buffer->getBufferSize() + 1;
+    if (nextBase + size > std::numeric_limits<uint32_t>::max())
+        llvm::report_fatal_error("source input exceeds the 4 GB location space");
+
+    files.push_back(std::make_unique<SourceFile>(std::move(path), std::move(buffer),
+                                                 static_cast<uint32_t>(nextBase)));
+    nextBase += size;
+    return *files.back();
+}
+
+const SourceFile *SourceManager::getFile(SourceLocation loc) const {
+    if (!loc.isValid())
+        return nullptr;
+    auto it = std::upper_bound(files.begin(), files.end(), loc.id,
+        [](uint32_t id, const std::unique_ptr<SourceFile> &file) { return id < file->base; });
+    if (it == files.begin())
+        return nullptr;
+    return (it - 1)->get();
+}
+
+PresumedLoc SourceManager::getPresumedLoc(SourceLocation loc) const {
+    const SourceFile *file = getFile(loc);
+    if (!file)
+        return PresumedLoc{};
+    auto [line, col] = file->getLineAndColumn(file->getOffset(loc));
+    return PresumedLoc{file->path, line, col};
+}
+
+llvm::StringRef SourceManager::getCharacterData(SourceLocation loc, size_t length) const {
+    const SourceFile *file = getFile(loc);
+    if (!file)
+        return llvm::StringRef();
+    return file->buffer.substr(file->getOffset(loc), length);
+}
@@ -0,0 +1,64 @@
+#include "streamingfrontend.h"
+#include <algorithm>
+
+#include "lexer.h"
+#include "parser.h"
+#include "sema.h"
+
+std::vector<FunctionDecl *> StreamingFrontend::parseSignatures() {
+    TheLexer lexer(SM, file);
+    Parser parser(lexer, context);
+    parser.setSkipFunctionBodies(true);
+    functions = parser.parseProgram();
+    stats = Stats{};
+    stats.functions = functions.size();
+    return functions;
+}
+
+Block *StreamingFrontend::parseBody(size_t index) {
+    // A function's tokens end where the next one's 'func' begins. The first
+    // pass reported their lexer diagnostics already.
+    size_t begin = file.getOffset(functions[index]->location);
+    size_t end = index + 1 < functions.size()
+        ? file.getOffset(functions[index + 1]->location) : file.buffer.size();
+    std::vector<Diagnostic> reported;
+
+    // A signature holds no braces: the body starts at the first '{'.
+    TheLexer scan(SM, file, begin, end);
+    scan.setDiagnosticBuffer(&reported);
+    Token token = scan.getNextToken();
+    while (token.kind != TokenKind::lbrace && token.kind != TokenKind::eof)
+        token = scan.getNextToken();
+
+    TheLexer lexer(SM, file, file.getOffset(token.location), end);
+    lexer.setDiagnosticBuffer(&reported);
+    Parser parser(lexer, bodyContext);
+    return parser.parseBody();
+}
+
+bool StreamingFrontend::run(llvm::function_ref<void(FunctionDecl &)> lower) {
+    SemanticAnalysis sema(SM);
+    if (foldConstants) sema.setConstantFolding(&bodyContext);
+    for (FunctionDecl *function : functions) {
+        if (!sema.resolveFunctionSignature(*function))
+            return false;
+        sema.declareFunction(*function);
+    }
+
+    for (size_t i = 0; i < functions.size(); ++i) {
+        FunctionDecl &function = *functions[i];
+        function.body = parseBody(i);
+        bool ok = function.body && sema.resolveFunctionBody(function);
+        if (ok) {
+            sema.foldConstants(functions[i]);
+            lower(function);
+        }
+        stats.peakBodyMemory = std::max(stats.peakBodyMemory, bodyContext.getTotalMemory());
+        function.body = nullptr;
+        bodyContext.reset();
+        if (!ok)
+            return false;
+    }
+    stats.constantsFolded = sema.getFoldStats().folded;
+    return true;
+}
@@ -0,0 +1,71 @@
+#!/bin/sh
+# Usage: ast_cache.sh <ram-compiler> <input> <edited input>
+#
+# Compiles a copy of <input> with -ast-cache over and over, and fails if a
+# run does not hit or miss the cache as it should, or if its output, IR or
+# exit status differ from compiling the same text with the same flags and
+# no cache. <edited input> must be the same size as <input>, so that only
+# the content hash tells them apart; it is copied over the input part-way.
+# A cache whose build ID, at offset 16, is not this compiler's must miss.
+
+compiler=$1
+input=$2
+edited=$3
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+cd "$tmp" || exit 1
+cp "$input" source.al
+
+status=0
+
+# Runs the compiler on source.al, keeping everything but the timings.
+compile() {
+    "$compiler" "$@" source.al > raw 2>&1
+    echo "exit status $?" >> raw
+    grep -v '^\[stats\]' raw > out
+    cat Output.ll >> out 2>/dev/null
+    rm -f Output.ll
+}
+
+# check <expected status> <flags>...
+check() {
+    want=$1
+    shift
+    compile "$@"
+    mv out expected
+    compile -ast-cache -frontend-stats "$@"
+    got=$(sed -n 's/^\[stats\] ast cache: \(.*\), [0-9]* nodes, .*/\1/p' raw)
+    if [ "$got" != "$want" ]; then
+        echo "FAIL: expected '$want' with '$*', got '$got'"
+        status=1
+    fi
+    if ! diff -u expected out; then
+        echo "FAIL: output with '$*' differs when the AST comes from the cache"
+        status=1
+    fi
+}
+
+stale="miss (source, mode or compiler changed)"
+
+check "miss (no cache)"
+check "hit"
+cp "$edited" source.al
+check "$stale"
+check "hit"
+check "$stale" -lazy-bodies
+check "hit" -lazy-bodies
+check "$stale"
+check "$stale" -const-eval=false
+check "hit" -const-eval=false
+check "$stale" -lazy-bodies -const-eval=false
+check "hit" -lazy-bodies -const-eval=false
+check "$stale"
+check "hit"
+printf x | dd of=source.al.astcache bs=1 seek=16 conv=notrunc 2>/dev/null
+check "$stale"
+check "hit"
+head -c 100 "$edited" > source.astcache.tmp
+mv source.astcache.tmp source.al.astcache
+check "miss (damaged cache)"
+check "hit"
+exit $status
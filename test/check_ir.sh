@@ -0,0 +1,50 @@
+#!/bin/sh
+# Usage: check_ir.sh <ram-compiler> "<flags>" <prefix> <input>...
+#
+# Compiles every input with the flags and matches the Output.ll it writes
+# against the input's "// <prefix>: <regex>" lines, each of which must
+# match some line of the IR, and its "// <prefix>-NOT: <regex>" lines, none
+# of which may. The regexes are grep -E ones; the prefix picks the checks
+# for these flags.
+
+compiler=$1
+flags=$2
+prefix=$3
+shift 3
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+cd "$tmp" || exit 1
+
+status=0
+for input in "$@"; do
+    rm -f Output.ll
+    if ! "$compiler" $flags "$input" > compile.log 2>&1 || [ ! -f Output.ll ]; then
+        echo "FAIL: $input does not compile with '$flags'"
+        cat compile.log
+        status=1
+        continue
+    fi
+    sed -n "s|^// $prefix: ||p" "$input" > checks
+    sed -n "s|^// $prefix-NOT: ||p" "$input" > checkNots
+    if [ ! -s checks ] && [ ! -s checkNots ]; then
+        echo "FAIL: $input has no $prefix checks"
+        status=1
+    fi
+    while IFS= read -r pattern; do
+        if ! grep -Eq -- "$pattern" Output.ll; then
+            echo "FAIL: $input with '$flags': no line of the IR matches '$pattern'"
+            status=1
+        fi
+    done < checks
+    while IFS= read -r pattern; do
+        if grep -Eq -- "$pattern" Output.ll; then
+            echo "FAIL: $input with '$flags': the IR has '$(grep -E -m 1 -- "$pattern" Output.ll)'"
+            status=1
+        fi
+    done < checkNots
+    if [ $status -ne 0 ]; then
+        echo "--- Output.ll ---"
+        cat Output.ll
+    fi
+done
+exit $status
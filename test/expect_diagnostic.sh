@@ -0,0 +1,32 @@
+#!/bin/sh
+# Usage: expect_diagnostic.sh <ram-compiler> <input>...
+#
+# Compiles every input and checks the result against the input's first
+# line: "// expect: success" for a clean compile, or "// expect: <line>:<col>:
+# error: <message>" for the first diagnostic. Runs in a scratch directory,
+# since the compiler writes its object file to the working directory.
+
+compiler=$1
+shift
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+cd "$tmp" || exit 1
+
+status=0
+for input in "$@"; do
+    expected=$(sed -n '1s|^// expect: ||p' "$input")
+    "$compiler" "$input" > out 2>&1
+    exitStatus=$?
+    diagnostic=$(grep -m 1 'error' out | sed "s|^$input:||")
+    if [ "$expected" = success ]; then
+        if [ $exitStatus -ne 0 ] || [ -n "$diagnostic" ]; then
+            echo "FAIL: $input: expected a clean compile, got exit status $exitStatus"
+            cat out
+            status=1
+        fi
+    elif [ $exitStatus -eq 0 ] || [ "$diagnostic" != "$expected" ]; then
+        echo "FAIL: $input: expected '$expected', got '$diagnostic' (exit status $exitStatus)"
+        status=1
+    fi
+done
+exit $status
@@ -0,0 +1,45 @@
+#!/bin/sh
+# Usage: expect_output.sh <ram-compiler> <cc> "<flags>" <input>...
+#
+# Compiles every input with the flags, links the object file with <cc> and
+# runs the program, and fails unless it exits with status 0 and prints the
+# input's "// output: <line>" lines, in order. Trailing spaces are ignored,
+# since print ends each value with one. A run is stopped after 10 seconds.
+# Runs in a scratch directory, since the compiler writes its object file to
+# the working directory.
+
+compiler=$1
+cc=$2
+flags=$3
+shift 3
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+cd "$tmp" || exit 1
+
+status=0
+for input in "$@"; do
+    rm -f output.o program
+    if ! "$compiler" $flags "$input" > compile.log 2>&1; then
+        echo "FAIL: $input does not compile with '$flags'"
+        cat compile.log
+        status=1
+        continue
+    fi
+    if ! "$cc" -no-pie output.o -o program > link.log 2>&1; then
+        echo "FAIL: $input does not link"
+        cat link.log
+        status=1
+        continue
+    fi
+    sed -n 's|^// output: ||p' "$input" > expected
+    echo "exit status 0" >> expected
+    timeout 10 ./program > raw 2>&1
+    exitStatus=$?
+    sed 's/ *$//' raw > actual
+    echo "exit status $exitStatus" >> actual
+    if ! diff -u expected actual; then
+        echo "FAIL: $input with '$flags' does not print what it expects"
+        status=1
+    fi
+done
+exit $status
@@ -0,0 +1,198 @@
+// Differential test of the incremental front end. Applies random edits to
+// each input and, after every edit, compares the document with one opened
+// from scratch on the same text:
+//  - each unit after the first (which starts at 0) starts on a token of a
+//    whole-file lex, and the units are the ones a from-scratch parse cuts
+//    the text into;
+//  - the AST, dumped with sema's types, is the same;
+//  - the diagnostics are the same, and the lexer and parser ones are those
+//    of a whole-file TheLexer + Parser run.
+//
+//   incremental-test [-edits=N] [-seed=S] <input>...
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "astcontext.h"
+#include "incremental.h"
+#include "lexer.h"
+#include "parser.h"
+#include "sourcemanager.h"
+
+namespace cl = llvm::cl;
+
+static cl::list<std::string> inputs(cl::Positional, cl::desc("<input files>"), cl::OneOrMore);
+static cl::opt<unsigned> numEdits("edits", cl::desc("Random edits per input"), cl::init(3000));
+static cl::opt<unsigned> seed("seed", cl::desc("Random seed"), cl::init(1));
+
+namespace {
+const char *const snippets[] = {
+    "func ", "func f(a: int): int {", "func main(): void {", "}", "{", "(", ")", ";",
+    ",", "\n", " ", "int ", "float ", "bool ", "x", "y1", " = ", "1", "2.5", "+", "*",
+    "==", "<", "&&", "||", "return x;", "return;", "print(x);", "if (x < 2) { ", "} else {",
+    "while (y1) {", "\"", "\"str\"", "'", "#", "//", "/*", "*/", "main", "square",
+    "f(1, 2)", "bool b = true;", "@", "99999999999", "1.2.3",
+};
+
+std::string dump(const std::vector<FunctionDecl *> &functions) {
+    std::ostringstream out;
+    std::streambuf *old = std::cerr.rdbuf(out.rdbuf());
+    for (FunctionDecl *function : functions)
+        function->dump();
+    std::cerr.rdbuf(old);
+    return out.str();
+}
+
+std::string join(const std::vector<std::string> &lines) {
+    std::string out;
+    for (const std::string &line : lines)
+        out += line + "\n";
+    return out;
+}
+
+struct WholeFile {
+    std::vector<size_t> tokenOffsets;
+    std::vector<std::string> syntaxDiagnostics;
+};
+
+WholeFile lexAndParse(const std::string &path, const std::string &text) {
+    SourceManager sourceManager;
+    const SourceFile &file = sourceManager.addFile(
+        path, llvm::MemoryBuffer::getMemBuffer(text, path, /*RequiresNullTerminator=*/false));
+    WholeFile result;
+
+    std::vector<Diagnostic> ignored;
+    TheLexer tokens{sourceManager, file};
+    tokens.setDiagnosticBuffer(&ignored);
+    for (Token tok = tokens.getNextToken();; tok = tokens.getNextToken()) {
+        result.tokenOffsets.push_back(file.getOffset(tok.location));
+        if (tok.kind == TokenKind::eof) break;
+    }
+
+    std::vector<Diagnostic> diagnostics, parserDiagnostics;
+    TheLexer lexer{sourceManager, file};
+    lexer.setDiagnosticBuffer(&diagnostics);
+    ASTContext context;
+    Parser parser(lexer, context);
+    parser.setDiagnosticBuffer(&parserDiagnostics);
+    parser.parseProgram();
+    diagnostics.insert(diagnostics.end(), parserDiagnostics.begin(), parserDiagnostics.end());
+    std::stable_sort(diagnostics.begin(), diagnostics.end(),
+                     [](const Diagnostic &a, const Diagnostic &b) { return a.location < b.location; });
+    for (const Diagnostic &diag : diagnostics)
+        result.syntaxDiagnostics.push_back(formatDiagnostic(sourceManager, diag));
+    return result;
+}
+
+TextEdit randomEdit(const std::string &text, const std::string &original, std::mt19937 &rng) {
+    auto below = [&rng](size_t n) { return std::uniform_int_distribution<size_t>(0, n)(rng); };
+    TextEdit edit;
+    // Keep the document from drifting too far: now and then, or once it has
+    // grown a lot, put the original back in one edit.
+    if (below(200) == 0 || text.size() > 4 * original.size() + 256) {
+        edit.removedLength = text.size();
+        edit.insertedText = original;
+        return edit;
+    }
+    edit.offset = below(text.size());
+    switch (below(3)) {
+        case 0:  // type something
+            edit.insertedText = snippets[below(std::size(snippets) - 1)];
+            break;
+        case 1:  // delete something
+            edit.removedLength = below(16);
+            break;
+        default:  // replace something
+            edit.removedLength = below(8);
+            edit.insertedText = snippets[below(std::size(snippets) - 1)];
+            break;
+    }
+    return edit;
+}
+
+// Where the two texts first differ, for the failure message.
+std::string firstDifference(const std::string &expected, const std::string &actual) {
+    std::istringstream a(expected), b(actual);
+    std::string lineA, lineB;
+    while (true) {
+        bool moreA = static_cast<bool>(std::getline(a, lineA));
+        bool moreB = static_cast<bool>(std::getline(b, lineB));
+        if (!moreA && !moreB) return "";
+        if (!moreA || !moreB || lineA != lineB)
+            return "  expected: " + (moreA ? lineA : "<end>") + "\n" +
+                   "  actual:   " + (moreB ? lineB : "<end>") + "\n";
+    }
+}
+}
+
+int main(int argc, const char **argv) {
+    cl::ParseCommandLineOptions(argc, argv, "Incremental front end differential test\n");
+
+    std::mt19937 rng(seed);
+    size_t checked = 0;
+    for (const std::string &path : inputs) {
+        auto bufferOrErr = llvm::MemoryBuffer::getFile(path);
+        if (!bufferOrErr) {
+            std::cerr << "cannot read " << path << "\n";
+            return 1;
+        }
+        std::string original = bufferOrErr.get()->getBuffer().str();
+        std::string text = original;
+        IncrementalFrontend document{path, text};
+
+        for (unsigned i = 0; i < numEdits; ++i) {
+            TextEdit edit = randomEdit(text, original, rng);
+            text.replace(std::min(edit.offset, text.size()),
+                         std::min(edit.removedLength, text.size() - std::min(edit.offset, text.size())),
+                         edit.insertedText);
+            document.applyEdit(edit);
+
+            IncrementalFrontend fresh{path, text};
+            WholeFile whole = lexAndParse(path, text);
+            std::vector<std::string> diagnostics = document.getDiagnostics();
+            std::vector<size_t> units = document.getUnitOffsets();
+            std::string failure;
+
+            if (document.getText() != text) {
+                failure = "text differs\n";
+            } else if (units != fresh.getUnitOffsets()) {
+                failure = "units differ from a fresh parse\n";
+            } else if (!std::all_of(units.begin() + 1, units.end(), [&](size_t offset) {
+                           return std::binary_search(whole.tokenOffsets.begin(),
+                                                     whole.tokenOffsets.end(), offset);
+                       })) {
+                failure = "a unit does not start on a token\n";
+            } else if (dump(document.getFunctions()) != dump(fresh.getFunctions())) {
+                failure = "AST differs from a fresh parse\n" +
+                          firstDifference(dump(fresh.getFunctions()), dump(document.getFunctions()));
+            } else if (diagnostics != fresh.getDiagnostics()) {
+                failure = "diagnostics differ from a fresh parse\n" +
+                          firstDifference(join(fresh.getDiagnostics()), join(diagnostics));
+            } else if (diagnostics.size() < whole.syntaxDiagnostics.size() ||
+                       !std::equal(whole.syntaxDiagnostics.begin(), whole.syntaxDiagnostics.end(),
+                                   diagnostics.begin())) {
+                diagnostics.resize(std::min(diagnostics.size(), whole.syntaxDiagnostics.size()));
+                failure = "syntax diagnostics differ from a whole-file parse\n" +
+                          firstDifference(join(whole.syntaxDiagnostics), join(diagnostics));
+            }
+
+            if (!failure.empty()) {
+                std::cerr << path << ": edit " << i + 1 << " (seed " << seed << ") at offset "
+                          << edit.offset << ", removing " << edit.removedLength
+                          << ", inserting \"" << edit.insertedText << "\": " << failure
+                          << "--- text ---\n" << text << "\n";
+                return 1;
+            }
+            ++checked;
+        }
+    }
+    std::cout << checked << " edits checked\n";
+    return 0;
+}
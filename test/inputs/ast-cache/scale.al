@@ -0,0 +1,8 @@
+func scale(n: int): int {
+    return n * 3;
+}
+
+func main(): void {
+    int limit = 2 * 3 + 1;
+    print(scale(limit));
+}
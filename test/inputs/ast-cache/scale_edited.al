@@ -0,0 +1,8 @@
+func scale(n: int): int {
+    return n * 4;
+}
+
+func main(): void {
+    int limit = 2 * 5 + 1;
+    print(scale(limit));
+}
@@ -0,0 +1,21 @@
+// expect: success
+func isSmall(n: int): bool {
+    return n < 10;
+}
+
+func pick(small: bool, n: int): int {
+    if (small) {
+        return n;
+    }
+    return 0;
+}
+
+func main(): void {
+    bool done = false;
+    int i = 0;
+    while (done == false) {
+        i = i + 1;
+        done = i > 3 || isSmall(i) == false;
+    }
+    print(pick(isSmall(i), i), done + 1);
+}
@@ -0,0 +1,4 @@
+// expect: 3:19: error: initializer type does not match variable type
+func main(): void {
+    float f = 1.5 < 2.5;
+}
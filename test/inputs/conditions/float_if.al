@@ -0,0 +1,7 @@
+// expect: 4:9: error: if condition must be an integer (boolean)
+func main(): void {
+    float f = 1.5;
+    if (f) {
+        print(f);
+    }
+}
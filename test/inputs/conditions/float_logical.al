@@ -0,0 +1,7 @@
+// expect: 4:18: error: right operand of logical operator must be an integer (boolean)
+func main(): void {
+    float f = 1.5;
+    if (1 < 2 && f) {
+        print(f);
+    }
+}
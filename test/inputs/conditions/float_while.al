@@ -0,0 +1,7 @@
+// expect: 4:14: error: while condition must be an integer (boolean)
+func main(): void {
+    float f = 1.5;
+    while (f * 2.0) {
+        f = f - 1.0;
+    }
+}
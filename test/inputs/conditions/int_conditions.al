@@ -0,0 +1,19 @@
+// expect: success
+func less(a: int, b: int): int {
+    return a < b;
+}
+
+func main(): void {
+    int n = 3;
+    int flag = n > 1;
+    int sum = (n < 5) + flag;
+    while (n) {
+        n = n - 1;
+    }
+    if (less(1, 2) && n == 0) {
+        print(sum);
+    }
+    if (1.5 < 2.5 || flag) {
+        print(less(n < 1, 2));
+    }
+}
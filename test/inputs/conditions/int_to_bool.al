@@ -0,0 +1,4 @@
+// expect: 3:14: error: initializer type does not match variable type
+func main(): void {
+    bool b = 1;
+}
@@ -0,0 +1,6 @@
+// expect: 3:9: error: if condition must be an integer (boolean)
+func main(): void {
+    if ("yes") {
+        print(1);
+    }
+}
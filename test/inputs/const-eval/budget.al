@@ -0,0 +1,19 @@
+func count(n: int): int {
+    int i = 0;
+    while (i < n) {
+        i = i + 1;
+    }
+    return i;
+}
+
+func twice(): int {
+    return count(6000) + count(6000);
+}
+
+func main(): void {
+    print(count(6000));
+    print(count(6000));
+    print(count(6000));
+    print(count(6000));
+    print(twice());
+}
@@ -0,0 +1,36 @@
+func square(n: int): int {
+    return n * n;
+}
+
+func sumTo(n: int): int {
+    int total = 0;
+    int i = 1;
+    while (i <= n) {
+        total = total + square(i);
+        i = i + 1;
+    }
+    return total;
+}
+
+func isSmall(n: int): bool {
+    return n < 10 && n > 0 - 10;
+}
+
+func scale(x: float, by: int): float {
+    return x * by;
+}
+
+func report(label: string, value: int): void {
+    print(label, value);
+}
+
+func main(): void {
+    int n = sumTo(5);
+    if (isSmall(n) || n == 55) {
+        report("sum", n);
+    } else {
+        print(scale(1.5, n));
+    }
+    # a call to a function that does not exist yet
+    missing(n);
+}
@@ -0,0 +1,17 @@
+func square(n: int): int {
+    return n * n;
+}
+
+func sumTo(n: int): int {
+    int total = 0;
+    int i = 1;
+    while (i <= n) {
+        total = total + square(i);
+        i = i + 1;
+    }
+    return total;
+}
+
+func main(): void {
+    print(sumTo(10));
+}
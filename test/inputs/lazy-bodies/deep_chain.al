@@ -0,0 +1,27 @@
+func d(x: int): int {
+    return x + undefined_name;
+}
+
+func c(x: int): int {
+    return d(x) * 2;
+}
+
+func unused(x: int): int {
+    return x;
+}
+
+func b(x: int): int {
+    if (x > 1) {
+        return c(x - 1);
+    }
+    return missing_function(x);
+}
+
+func a(x: int): int {
+    return b(x) + c(x);
+}
+
+func main(): void {
+    print(a(3));
+    print(1.5 + "text");
+}
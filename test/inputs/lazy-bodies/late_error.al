@@ -0,0 +1,12 @@
+func helper(n: int): int {
+    return n * 2.5;
+}
+
+func middle(n: int): int {
+    return helper(n) + 1;
+}
+
+func main(): void {
+    print(middle(2));
+    int s = "text";
+}
@@ -0,0 +1,5 @@
+// expect: 3:13: error: integer literal '2147483648' is too large for type 'int'
+func main(): void {
+    int x = 2147483648;
+    print(x);
+}
@@ -0,0 +1,5 @@
+// expect: 3:13: error: integer literal '99999999999999999999' is too large for type 'int'
+func main(): void {
+    int x = 99999999999999999999;
+    print(x);
+}
@@ -0,0 +1,5 @@
+// expect: 3:15: error: invalid number literal '1.2.3': more than one '.'
+func main(): void {
+    float x = 1.2.3;
+    print(x);
+}
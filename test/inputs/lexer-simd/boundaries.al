@@ -0,0 +1,264 @@
+var i_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+print("\"esc\\aped\ntttttttttttttttttttttttttttttttt");
+print('\rrrrrrrrrrrrrrrrr');
+#  /* not a block */ "not a string
+// ddddddddddddddddddddddddddddddd*/ still a line comment
+/* / * */ x********************************/ y;
+
+																																z = z + 1;
+ var ii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ print("s\"esc\\aped\nttttttttttttttttttttttttttttttt");
+ print('q\rrrrrrrrrrrrrrrrr');
+ # c /* not a block */ "not a string
+ // dddddddddddddddddddddddddddddd*/ still a line comment
+ /** / * */ x *******************************/ y;
+ 
+ 																															z = z + 1;
+ 	var iii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	print("ss\"esc\\aped\ntttttttttttttttttttttttttttttt");
+ 	print('qq\rrrrrrrrrrrrrrrrr');
+ 	# cc /* not a block */ "not a string
+ 	// ddddddddddddddddddddddddddddd*/ still a line comment
+ 	/*** / * */ x  ******************************/ y;
+ 	
+  																														z = z + 1;
+ 	 var iiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 print("sss\"esc\\aped\nttttttttttttttttttttttttttttt");
+ 	 print('qqq\rrrrrrrrrrrrrrrrr');
+ 	 # ccc /* not a block */ "not a string
+ 	 // dddddddddddddddddddddddddddd*/ still a line comment
+ 	 /**** / * */ x   *****************************/ y;
+ 	 
+   																													z = z + 1;
+ 	 	var iiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	print("ssss\"esc\\aped\ntttttttttttttttttttttttttttt");
+ 	 	print('qqqq\rrrrrrrrrrrrrrrrr');
+ 	 	# cccc /* not a block */ "not a string
+ 	 	// ddddddddddddddddddddddddddd*/ still a line comment
+ 	 	/***** / * */ x    ****************************/ y;
+ 	 	
+    																												z = z + 1;
+ 	 	 var iiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 print("sssss\"esc\\aped\nttttttttttttttttttttttttttt");
+ 	 	 print('qqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 # ccccc /* not a block */ "not a string
+ 	 	 // dddddddddddddddddddddddddd*/ still a line comment
+ 	 	 /****** / * */ x     ***************************/ y;
+ 	 	 
+     																											z = z + 1;
+ 	 	 	var iiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	print("ssssss\"esc\\aped\ntttttttttttttttttttttttttt");
+ 	 	 	print('qqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	# cccccc /* not a block */ "not a string
+ 	 	 	// ddddddddddddddddddddddddd*/ still a line comment
+ 	 	 	/******* / * */ x      **************************/ y;
+ 	 	 	
+      																										z = z + 1;
+ 	 	 	 var iiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 print("sssssss\"esc\\aped\nttttttttttttttttttttttttt");
+ 	 	 	 print('qqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 # ccccccc /* not a block */ "not a string
+ 	 	 	 // dddddddddddddddddddddddd*/ still a line comment
+ 	 	 	 /******** / * */ x*************************/ y;
+ 	 	 	 
+       																									z = z + 1;
+ 	 	 	 	var iiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	print("ssssssss\"esc\\aped\ntttttttttttttttttttttttt");
+ 	 	 	 	print('qqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	# cccccccc /* not a block */ "not a string
+ 	 	 	 	// ddddddddddddddddddddddd*/ still a line comment
+ 	 	 	 	/********* / * */ x ************************/ y;
+ 	 	 	 	
+        																								z = z + 1;
+ 	 	 	 	 var iiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 print("sssssssss\"esc\\aped\nttttttttttttttttttttttt");
+ 	 	 	 	 print('qqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 # ccccccccc /* not a block */ "not a string
+ 	 	 	 	 // dddddddddddddddddddddd*/ still a line comment
+ 	 	 	 	 /********** / * */ x  ***********************/ y;
+ 	 	 	 	 
+         																							z = z + 1;
+ 	 	 	 	 	var iiiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 	print("ssssssssss\"esc\\aped\ntttttttttttttttttttttt");
+ 	 	 	 	 	print('qqqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 	# cccccccccc /* not a block */ "not a string
+ 	 	 	 	 	// ddddddddddddddddddddd*/ still a line comment
+ 	 	 	 	 	/*********** / * */ x   **********************/ y;
+ 	 	 	 	 	
+          																						z = z + 1;
+ 	 	 	 	 	 var iiiiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 	 print("sssssssssss\"esc\\aped\nttttttttttttttttttttt");
+ 	 	 	 	 	 print('qqqqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 	 # ccccccccccc /* not a block */ "not a string
+ 	 	 	 	 	 // dddddddddddddddddddd*/ still a line comment
+ 	 	 	 	 	 /************ / * */ x    *********************/ y;
+ 	 	 	 	 	 
+           																					z = z + 1;
+ 	 	 	 	 	 	var iiiiiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 	 	print("ssssssssssss\"esc\\aped\ntttttttttttttttttttt");
+ 	 	 	 	 	 	print('qqqqqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 	 	# cccccccccccc /* not a block */ "not a string
+ 	 	 	 	 	 	// ddddddddddddddddddd*/ still a line comment
+ 	 	 	 	 	 	/************* / * */ x     ********************/ y;
+ 	 	 	 	 	 	
+            																				z = z + 1;
+ 	 	 	 	 	 	 var iiiiiiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 	 	 print("sssssssssssss\"esc\\aped\nttttttttttttttttttt");
+ 	 	 	 	 	 	 print('qqqqqqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 	 	 # ccccccccccccc /* not a block */ "not a string
+ 	 	 	 	 	 	 // dddddddddddddddddd*/ still a line comment
+ 	 	 	 	 	 	 /************** / * */ x      *******************/ y;
+ 	 	 	 	 	 	 
+             																			z = z + 1;
+ 	 	 	 	 	 	 	var iiiiiiiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 	 	 	print("ssssssssssssss\"esc\\aped\ntttttttttttttttttt");
+ 	 	 	 	 	 	 	print('qqqqqqqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 	 	 	# cccccccccccccc /* not a block */ "not a string
+ 	 	 	 	 	 	 	// ddddddddddddddddd*/ still a line comment
+ 	 	 	 	 	 	 	/*************** / * */ x******************/ y;
+ 	 	 	 	 	 	 	
+              																		z = z + 1;
+ 	 	 	 	 	 	 	 var iiiiiiiiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 	 	 	 print("sssssssssssssss\"esc\\aped\nttttttttttttttttt");
+ 	 	 	 	 	 	 	 print('qqqqqqqqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 	 	 	 # ccccccccccccccc /* not a block */ "not a string
+ 	 	 	 	 	 	 	 // dddddddddddddddd*/ still a line comment
+ 	 	 	 	 	 	 	 /**************** / * */ x *****************/ y;
+ 	 	 	 	 	 	 	 
+               																	z = z + 1;
+ 	 	 	 	 	 	 	 	var iiiiiiiiiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 	 	 	 	print("ssssssssssssssss\"esc\\aped\ntttttttttttttttt");
+ 	 	 	 	 	 	 	 	print('qqqqqqqqqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 	 	 	 	# cccccccccccccccc /* not a block */ "not a string
+ 	 	 	 	 	 	 	 	// ddddddddddddddd*/ still a line comment
+ 	 	 	 	 	 	 	 	/***************** / * */ x  ****************/ y;
+ 	 	 	 	 	 	 	 	
+                																z = z + 1;
+ 	 	 	 	 	 	 	 	 var iiiiiiiiiiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 	 	 	 	 print("sssssssssssssssss\"esc\\aped\nttttttttttttttt");
+ 	 	 	 	 	 	 	 	 print('qqqqqqqqqqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 	 	 	 	 # ccccccccccccccccc /* not a block */ "not a string
+ 	 	 	 	 	 	 	 	 // dddddddddddddd*/ still a line comment
+ 	 	 	 	 	 	 	 	 /****************** / * */ x   ***************/ y;
+ 	 	 	 	 	 	 	 	 
+                 															z = z + 1;
+ 	 	 	 	 	 	 	 	 	var iiiiiiiiiiiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 	 	 	 	 	print("ssssssssssssssssss\"esc\\aped\ntttttttttttttt");
+ 	 	 	 	 	 	 	 	 	print('qqqqqqqqqqqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 	 	 	 	 	# cccccccccccccccccc /* not a block */ "not a string
+ 	 	 	 	 	 	 	 	 	// ddddddddddddd*/ still a line comment
+ 	 	 	 	 	 	 	 	 	/******************* / * */ x    **************/ y;
+ 	 	 	 	 	 	 	 	 	
+                  														z = z + 1;
+ 	 	 	 	 	 	 	 	 	 var iiiiiiiiiiiiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 	 	 	 	 	 print("sssssssssssssssssss\"esc\\aped\nttttttttttttt");
+ 	 	 	 	 	 	 	 	 	 print('qqqqqqqqqqqqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 	 	 	 	 	 # ccccccccccccccccccc /* not a block */ "not a string
+ 	 	 	 	 	 	 	 	 	 // dddddddddddd*/ still a line comment
+ 	 	 	 	 	 	 	 	 	 /******************** / * */ x     *************/ y;
+ 	 	 	 	 	 	 	 	 	 
+                   													z = z + 1;
+ 	 	 	 	 	 	 	 	 	 	var iiiiiiiiiiiiiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 	 	 	 	 	 	print("ssssssssssssssssssss\"esc\\aped\ntttttttttttt");
+ 	 	 	 	 	 	 	 	 	 	print('qqqqqqqqqqqqqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 	 	 	 	 	 	# cccccccccccccccccccc /* not a block */ "not a string
+ 	 	 	 	 	 	 	 	 	 	// ddddddddddd*/ still a line comment
+ 	 	 	 	 	 	 	 	 	 	/********************* / * */ x      ************/ y;
+ 	 	 	 	 	 	 	 	 	 	
+                    												z = z + 1;
+ 	 	 	 	 	 	 	 	 	 	 var iiiiiiiiiiiiiiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 	 	 	 	 	 	 print("sssssssssssssssssssss\"esc\\aped\nttttttttttt");
+ 	 	 	 	 	 	 	 	 	 	 print('qqqqqqqqqqqqqqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 	 	 	 	 	 	 # ccccccccccccccccccccc /* not a block */ "not a string
+ 	 	 	 	 	 	 	 	 	 	 // dddddddddd*/ still a line comment
+ 	 	 	 	 	 	 	 	 	 	 /********************** / * */ x***********/ y;
+ 	 	 	 	 	 	 	 	 	 	 
+                     											z = z + 1;
+ 	 	 	 	 	 	 	 	 	 	 	var iiiiiiiiiiiiiiiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 	 	 	 	 	 	 	print("ssssssssssssssssssssss\"esc\\aped\ntttttttttt");
+ 	 	 	 	 	 	 	 	 	 	 	print('qqqqqqqqqqqqqqqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 	 	 	 	 	 	 	# cccccccccccccccccccccc /* not a block */ "not a string
+ 	 	 	 	 	 	 	 	 	 	 	// ddddddddd*/ still a line comment
+ 	 	 	 	 	 	 	 	 	 	 	/*********************** / * */ x **********/ y;
+ 	 	 	 	 	 	 	 	 	 	 	
+                      										z = z + 1;
+ 	 	 	 	 	 	 	 	 	 	 	 var iiiiiiiiiiiiiiiiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 	 	 	 	 	 	 	 print("sssssssssssssssssssssss\"esc\\aped\nttttttttt");
+ 	 	 	 	 	 	 	 	 	 	 	 print('qqqqqqqqqqqqqqqqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 	 	 	 	 	 	 	 # ccccccccccccccccccccccc /* not a block */ "not a string
+ 	 	 	 	 	 	 	 	 	 	 	 // dddddddd*/ still a line comment
+ 	 	 	 	 	 	 	 	 	 	 	 /************************ / * */ x  *********/ y;
+ 	 	 	 	 	 	 	 	 	 	 	 
+                       									z = z + 1;
+ 	 	 	 	 	 	 	 	 	 	 	 	var iiiiiiiiiiiiiiiiiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 	 	 	 	 	 	 	 	print("ssssssssssssssssssssssss\"esc\\aped\ntttttttt");
+ 	 	 	 	 	 	 	 	 	 	 	 	print('qqqqqqqqqqqqqqqqqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 	 	 	 	 	 	 	 	# cccccccccccccccccccccccc /* not a block */ "not a string
+ 	 	 	 	 	 	 	 	 	 	 	 	// ddddddd*/ still a line comment
+ 	 	 	 	 	 	 	 	 	 	 	 	/************************* / * */ x   ********/ y;
+ 	 	 	 	 	 	 	 	 	 	 	 	
+                        								z = z + 1;
+ 	 	 	 	 	 	 	 	 	 	 	 	 var iiiiiiiiiiiiiiiiiiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 	 	 	 	 	 	 	 	 print("sssssssssssssssssssssssss\"esc\\aped\nttttttt");
+ 	 	 	 	 	 	 	 	 	 	 	 	 print('qqqqqqqqqqqqqqqqqqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 	 	 	 	 	 	 	 	 # ccccccccccccccccccccccccc /* not a block */ "not a string
+ 	 	 	 	 	 	 	 	 	 	 	 	 // dddddd*/ still a line comment
+ 	 	 	 	 	 	 	 	 	 	 	 	 /************************** / * */ x    *******/ y;
+ 	 	 	 	 	 	 	 	 	 	 	 	 
+                         							z = z + 1;
+ 	 	 	 	 	 	 	 	 	 	 	 	 	var iiiiiiiiiiiiiiiiiiiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 	 	 	 	 	 	 	 	 	print("ssssssssssssssssssssssssss\"esc\\aped\ntttttt");
+ 	 	 	 	 	 	 	 	 	 	 	 	 	print('qqqqqqqqqqqqqqqqqqqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 	 	 	 	 	 	 	 	 	# cccccccccccccccccccccccccc /* not a block */ "not a string
+ 	 	 	 	 	 	 	 	 	 	 	 	 	// ddddd*/ still a line comment
+ 	 	 	 	 	 	 	 	 	 	 	 	 	/*************************** / * */ x     ******/ y;
+ 	 	 	 	 	 	 	 	 	 	 	 	 	
+                          						z = z + 1;
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 var iiiiiiiiiiiiiiiiiiiiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 print("sssssssssssssssssssssssssss\"esc\\aped\nttttt");
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 print('qqqqqqqqqqqqqqqqqqqqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 # ccccccccccccccccccccccccccc /* not a block */ "not a string
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 // dddd*/ still a line comment
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 /**************************** / * */ x      *****/ y;
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 
+                           					z = z + 1;
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	var iiiiiiiiiiiiiiiiiiiiiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	print("ssssssssssssssssssssssssssss\"esc\\aped\ntttt");
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	print('qqqqqqqqqqqqqqqqqqqqqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	# cccccccccccccccccccccccccccc /* not a block */ "not a string
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	// ddd*/ still a line comment
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	/***************************** / * */ x****/ y;
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	
+                            				z = z + 1;
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 var iiiiiiiiiiiiiiiiiiiiiiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 print("sssssssssssssssssssssssssssss\"esc\\aped\nttt");
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 print('qqqqqqqqqqqqqqqqqqqqqqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 # ccccccccccccccccccccccccccccc /* not a block */ "not a string
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 // dd*/ still a line comment
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 /****************************** / * */ x ***/ y;
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 
+                             			z = z + 1;
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	var iiiiiiiiiiiiiiiiiiiiiiiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	print("ssssssssssssssssssssssssssssss\"esc\\aped\ntt");
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	print('qqqqqqqqqqqqqqqqqqqqqqqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	# cccccccccccccccccccccccccccccc /* not a block */ "not a string
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	// d*/ still a line comment
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	/******************************* / * */ x  **/ y;
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	
+                              		z = z + 1;
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 var iiiiiiiiiiiiiiiiiiiiiiiiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 print("sssssssssssssssssssssssssssssss\"esc\\aped\nt");
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 print('qqqqqqqqqqqqqqqqqqqqqqqqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 # ccccccccccccccccccccccccccccccc /* not a block */ "not a string
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 // */ still a line comment
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 /******************************** / * */ x   */ y;
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 
+                               	z = z + 1;
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	var iiiiiiiiiiiiiiiiiiiiiiiiiiiiiiiii_abcdefghijklmnopqrstuvwxyz0123456789 = 1;
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	print("ssssssssssssssssssssssssssssssss\"esc\\aped\n");
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	print('qqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqq\rrrrrrrrrrrrrrrrr');
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	# cccccccccccccccccccccccccccccccc /* not a block */ "not a string
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	// */ still a line comment
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	/********************************* / * */ x    / y;
+ 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	
+                                z = z + 1;
@@ -0,0 +1 @@
+var x = 1; /* bbbbbbbbbbbbbbbbbbbbbbbbbbbbbb *
\ No newline at end of file
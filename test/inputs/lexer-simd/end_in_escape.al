@@ -0,0 +1 @@
+print("eeeeeeeeeeeeeeeeeeeeeeeee\
\ No newline at end of file
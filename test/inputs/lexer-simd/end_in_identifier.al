@@ -0,0 +1 @@
+var wwwwwwwwwwwwwwwwwwwwwwwwwwwwwwwwwwwwwwwww
\ No newline at end of file
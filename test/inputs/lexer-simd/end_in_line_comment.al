@@ -0,0 +1 @@
+var y = 2; # llllllllllllllllllllllllllllllllllll
\ No newline at end of file
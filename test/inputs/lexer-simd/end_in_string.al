@@ -0,0 +1,2 @@
+func main(): void {
+    print("unterminated, no newline
\ No newline at end of file
@@ -0,0 +1,9 @@
+var v = 3; 	
+ 	
+ 	
+ 	
+ 	
+ 	
+ 	
+ 	
+ 	
@@ -0,0 +1,6 @@
+var a = 1;
+# 
+/*  */
+print("");
+      
+ident_tail
@@ -0,0 +1,19 @@
+// Without -O the helper stays a call in a loop; -O2 inlines it and drops it.
+// DEFAULT: define internal i32 @square\(
+// DEFAULT: call i32 @square\(
+// O2-NOT: @square
+// O2: define (dso_local )?i32 @main\(
+
+func square(n: int): int {
+    return n * n;
+}
+
+func main(): void {
+    int i = 0;
+    int total = 0;
+    while (i < 10) {
+        total = total + square(i);
+        i = i + 1;
+    }
+    print(total);
+}
@@ -0,0 +1,148 @@
+// Locals live in SSA values from -O0 on: phis where control flow joins,
+// and no stack slots.
+// O0: = phi i32
+// O0-NOT: alloca
+// O0-NOT: load
+// O0-NOT: store
+// output: 1 1
+// output: 55
+// output: 55
+// output: 30
+// output: 213
+// output: 1
+// output: 2
+// output: 3
+// output: 5
+// output: 5
+// output: 111
+// output: 1
+// output: 3
+// output: 4
+// output: 5
+// output: 10
+// output: 5
+
+func main(): void {
+    print(isEven(10), isOdd(7));
+    print(fib(10));
+    print(fibLoop(10));
+    print(sumSquares(4));
+    print(steps(3));
+    print(shortCircuit(1));
+    print(shortCircuit(0));
+    print(partial(5));
+}
+
+// Mutual recursion, called before either is declared.
+func isEven(n: int): int {
+    if (n == 0) {
+        return 1;
+    }
+    return isOdd(n - 1);
+}
+
+func isOdd(n: int): int {
+    if (n == 0) {
+        return 0;
+    }
+    return isEven(n - 1);
+}
+
+func fib(n: int): int {
+    if (n < 2) {
+        return n;
+    }
+    return fib(n - 1) + fib(n - 2);
+}
+
+// Two variables carried round the loop, each read before it is written.
+func fibLoop(n: int): int {
+    int a = 0;
+    int b = 1;
+    int i = 0;
+    while (i < n) {
+        int next = a + b;
+        a = b;
+        b = next;
+        i = i + 1;
+    }
+    return a;
+}
+
+// A loop nested in a loop, and a local declared afresh each iteration.
+func sumSquares(n: int): int {
+    int total = 0;
+    int i = 1;
+    while (i <= n) {
+        int j = 0;
+        while (j < i) {
+            int square = i * i;
+            total = total + square;
+            j = i;
+        }
+        i = i + 1;
+    }
+    return total;
+}
+
+// The same name declared in sibling scopes inside a loop, and again in a
+// second loop.
+func steps(n: int): int {
+    int total = 0;
+    int i = 0;
+    while (i < n) {
+        if (i < 1) {
+            int step = 10;
+            total = total + step;
+        } else {
+            int step = 100;
+            total = total + step;
+        }
+        i = i + 1;
+    }
+    while (i > 0) {
+        int step = 1;
+        total = total + step;
+        i = i - step;
+    }
+    return total;
+}
+
+func say(n: int, value: int): int {
+    print(n);
+    return value;
+}
+
+// Only the calls a && or || needs are made, and a variable assigned on
+// only some paths through them keeps the right value.
+func shortCircuit(x: int): int {
+    int seen = 0;
+    if (say(1, x) && say(2, 1)) {
+        seen = seen + 1;
+    }
+    if (say(3, x) || say(4, 1)) {
+        seen = seen + 10;
+    }
+    int i = 0;
+    while (i < 5 && say(5, x)) {
+        i = i + 1;
+        if (i > 1) {
+            seen = seen + 100;
+            i = 5;
+        }
+    }
+    return seen;
+}
+
+// A variable assigned in one branch only, then in a loop that may not run.
+func partial(n: int): int {
+    int result = 1;
+    if (n > 3) {
+        result = n;
+    }
+    while (n < 3) {
+        result = result * 2;
+        n = n + 1;
+    }
+    return result;
+}
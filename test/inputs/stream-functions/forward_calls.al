@@ -0,0 +1,35 @@
+func main(): void {
+    print(countDown(5));
+    print(isEven(10), isOdd(7));
+    print(twice(21));
+}
+
+func countDown(n: int): int {
+    if (n < 1) {
+        return 0;
+    }
+    print(n);
+    return 1 + countDown(n - 1);
+}
+
+func isEven(n: int): int {
+    if (n == 0) {
+        return 1;
+    }
+    return isOdd(n - 1);
+}
+
+func isOdd(n: int): int {
+    if (n == 0) {
+        return 0;
+    }
+    return isEven(n - 1);
+}
+
+func twice(n: int): int {
+    return add(n, n);
+}
+
+func add(a: int, b: int): int {
+    return a + b;
+}
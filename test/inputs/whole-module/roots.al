@@ -0,0 +1,23 @@
+// main is the only root: the called helper becomes internal, the unused
+// one is dropped, and main keeps external linkage.
+// DEFAULT: define internal i32 @used\(
+// DEFAULT: call i32 @used\(
+// DEFAULT-NOT: @unused
+// DEFAULT: define (dso_local )?i32 @main\(
+// DEFAULT-NOT: define internal i32 @main
+
+func unused(n: int): int {
+    return n + 1;
+}
+
+func used(n: int): int {
+    print(n);
+    return n * 2;
+}
+
+func main(): void {
+    int i = 1;
+    while (i < 20) {
+        i = i + used(i);
+    }
+}
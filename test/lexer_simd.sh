@@ -0,0 +1,32 @@
+#!/bin/sh
+# Usage: lexer_simd.sh <ram-compiler> <input>...
+#
+# Lexes every input with each -lexer-simd implementation, on demand and in
+# chunks on three threads, and fails if any token stream, diagnostic or
+# exit status differs from the scalar on-demand one.
+
+compiler=$1
+shift
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+lex() {
+    "$compiler" -dump-tokens -syntax-only "$@" > "$tmp/out" 2>&1
+    echo "exit status $?" >> "$tmp/out"
+}
+
+status=0
+for input in "$@"; do
+    lex -lexer-simd=scalar "$input"
+    mv "$tmp/out" "$tmp/expected"
+    for isa in scalar sse2 avx2; do
+        for threads in 0 3; do
+            lex -lexer-simd=$isa -lex-threads=$threads "$input"
+            if ! diff -u "$tmp/expected" "$tmp/out"; then
+                echo "FAIL: $input differs with -lexer-simd=$isa -lex-threads=$threads"
+                status=1
+            fi
+        done
+    done
+done
+exit $status
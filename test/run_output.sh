@@ -0,0 +1,48 @@
+#!/bin/sh
+# Usage: run_output.sh <ram-compiler> <cc> "<flags>" "<other flags>" <input>...
+#
+# Compiles every input with each set of flags, links the object file with
+# <cc> and runs the program, and fails if either compile fails or if the
+# program's output or exit status differ. The inputs must be programs
+# that compile cleanly and finish; a run is stopped after 10 seconds. Runs
+# in a scratch directory, since the compiler writes its object file to the
+# working directory.
+
+compiler=$1
+cc=$2
+flags=$3
+otherFlags=$4
+shift 4
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+cd "$tmp" || exit 1
+
+# run <output file> <flags>...
+run() {
+    out=$1
+    shift
+    rm -f output.o program
+    if ! "$compiler" "$@" > compile.log 2>&1; then
+        echo "FAIL: '$*' does not compile"
+        cat compile.log
+        return 1
+    fi
+    if ! "$cc" -no-pie output.o -o program > link.log 2>&1; then
+        echo "FAIL: '$*' does not link"
+        cat link.log
+        return 1
+    fi
+    timeout 10 ./program > "$out" 2>&1
+    echo "exit status $?" >> "$out"
+}
+
+status=0
+for input in "$@"; do
+    run expected $flags "$input" || { status=1; continue; }
+    run actual $otherFlags "$input" || { status=1; continue; }
+    if ! diff -u expected actual; then
+        echo "FAIL: $input runs differently with '$flags' and '$otherFlags'"
+        status=1
+    fi
+done
+exit $status
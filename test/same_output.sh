@@ -0,0 +1,27 @@
+#!/bin/sh
+# Usage: same_output.sh <ram-compiler> "<flags>" "<other flags>" <input>...
+#
+# Compiles every input once with each set of flags and fails if the output,
+# diagnostics or exit status differ. Runs in a scratch directory, since the
+# compiler writes its object file to the working directory.
+
+compiler=$1
+flags=$2
+otherFlags=$3
+shift 3
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+cd "$tmp" || exit 1
+
+status=0
+for input in "$@"; do
+    "$compiler" $flags "$input" > expected 2>&1
+    echo "exit status $?" >> expected
+    "$compiler" $otherFlags "$input" > actual 2>&1
+    echo "exit status $?" >> actual
+    if ! diff -u expected actual; then
+        echo "FAIL: $input differs between '$flags' and '$otherFlags'"
+        status=1
+    fi
+done
+exit $status
@@ -0,0 +1,321 @@
+// Tests of sema's symbol table: which declaration each name in a body
+// resolves to, and which names are errors, across nested and sibling
+// scopes, parameters, and functions declared later or twice.
+//
+// Every program is checked by SemanticAnalysis::resolve and by ParallelSema
+// on one and on four threads. A ParallelSema run checks consecutive bodies
+// with one SemanticAnalysis that reads the frozen global scope, so leaving
+// each body has to bring back the globals its parameters hid.
+//
+//   symbols-test [-functions=N]
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "astcontext.h"
+#include "lexer.h"
+#include "parallelsema.h"
+#include "parser.h"
+#include "sema.h"
+#include "sourcemanager.h"
+
+namespace cl = llvm::cl;
+
+static cl::opt<unsigned> numFunctions(
+    "functions", cl::desc("Functions in the generated program, several ParallelSema runs' worth"),
+    cl::init(1000));
+
+namespace {
+struct Case {
+    const char *name;
+    const char *source;
+    // "<line> <name> -> <line of its declaration>" for each name used, in
+    // the order of the text, or the diagnostics if the program is wrong.
+    const char *expected;
+};
+
+const Case cases[] = {
+    {"nested and sibling scopes", R"(func f(n: int): int {
+    int total = n;
+    if (n < 10) {
+        int step = 2;
+        while (total < 20) {
+            int inner = step * 2;
+            total = total + inner;
+        }
+        int inner = 1;
+        total = total + inner;
+    } else {
+        float step = 0.5;
+        print(step);
+    }
+    int step = 3;
+    return total + step;
+}
+
+func main(): void {
+    print(f(1));
+}
+)",
+     "2 n -> 1\n"
+     "3 n -> 1\n"
+     "5 total -> 2\n"
+     "6 step -> 4\n"
+     "7 total -> 2\n"
+     "7 total -> 2\n"
+     "7 inner -> 6\n"
+     "10 total -> 2\n"
+     "10 total -> 2\n"
+     "10 inner -> 9\n"
+     "13 step -> 12\n"
+     "16 total -> 2\n"
+     "16 step -> 15\n"
+     "20 f -> 1\n"},
+
+    {"local redeclared in a nested scope", R"(func main(): void {
+    int x = 1;
+    if (true) {
+        while (x < 3) {
+            int x = 2;
+        }
+    }
+}
+)",
+     "input.al:5:13: error: variable 'x' redeclared\n"},
+
+    {"local hides a parameter", R"(func f(x: int): int {
+    if (x < 1) {
+        int x = 2;
+    }
+    return x;
+}
+)",
+     "input.al:3:9: error: variable 'x' redeclared\n"},
+
+    {"local hides a function declared later", R"(func main(): void {
+    int g = 1;
+}
+
+func g(): void {
+}
+)",
+     "input.al:2:5: error: variable 'g' redeclared\n"},
+
+    {"used after its scope", R"(func main(): void {
+    if (true) {
+        while (false) {
+            int y = 1;
+        }
+        print(y);
+    }
+}
+)",
+     "input.al:6:15: error: symbol 'y' not found\n"},
+
+    {"assigned after its scope", R"(func main(): void {
+    while (false) {
+        int y = 1;
+    }
+    y = 2;
+}
+)",
+     "input.al:5:7: error: assignment to undefined variable 'y'\n"},
+
+    {"local of an earlier body", R"(func f(): void {
+    int y = 1;
+}
+
+func g(): void {
+    print(y);
+}
+)",
+     "input.al:6:11: error: symbol 'y' not found\n"},
+
+    // A parameter may hide a function declared after its own, since a
+    // signature is checked against the functions before it; the next body
+    // must see the function again.
+    {"parameters hide later functions", R"(func a(b: int, c: int): int {
+    if (b < c) {
+        return c;
+    }
+    return b;
+}
+
+func b(): int {
+    return a(1, 2);
+}
+
+func c(): int {
+    return b() + a(b(), 3);
+}
+
+func main(): void {
+    print(c());
+}
+)",
+     "2 b -> 1\n"
+     "2 c -> 1\n"
+     "3 c -> 1\n"
+     "5 b -> 1\n"
+     "9 a -> 1\n"
+     "13 b -> 8\n"
+     "13 a -> 1\n"
+     "13 b -> 8\n"
+     "17 c -> 12\n"},
+
+    {"parameter hides an earlier function", R"(func b(): int {
+    return 1;
+}
+
+func a(b: int): int {
+    return b;
+}
+)",
+     "input.al:5:8: error: parameter 'b' redeclared\n"},
+
+    // The first of two functions with one name is the one found.
+    {"function defined twice", R"(func d(): int {
+    return 1;
+}
+
+func d(): float {
+    return 1.5;
+}
+
+func main(): void {
+    int x = d();
+}
+)",
+     "10 d -> 1\n"},
+};
+
+// Lists the declaration each name resolved to, in the order of the text.
+class ListBindings : public ASTVisitor<ListBindings> {
+    const SourceManager &SM;
+    std::string &out;
+
+    void add(SourceLocation use, Symbol name, const Decl *decl) {
+        out += std::to_string(SM.getPresumedLoc(use).line) + " " + name.str() + " -> " +
+               (decl ? std::to_string(SM.getPresumedLoc(decl->location).line) : "null") + "\n";
+    }
+
+public:
+    ListBindings(const SourceManager &SM, std::string &out) : SM(SM), out(out) {}
+
+    void visitFunctionDecl(FunctionDecl &node) { visit(*node.body); }
+    void visitBlock(Block &node) {
+        for (Stmt *stmt : node.statements) visit(*stmt);
+    }
+    void visitReturnStmt(ReturnStmt &node) {
+        if (node.expr) visit(*node.expr);
+    }
+    void visitIfStmt(IfStmt &node) {
+        visit(*node.condition);
+        visit(*node.thenBlock);
+        if (node.elseBlock) visit(*node.elseBlock);
+    }
+    void visitWhileStmt(WhileStmt &node) {
+        visit(*node.condition);
+        visit(*node.body);
+    }
+    void visitVariableDecl(VariableDecl &node) {
+        if (node.initializer) visit(*node.initializer);
+    }
+    void visitPrintExpr(PrintExpr &node) {
+        for (Expr *arg : node.args) visit(*arg);
+    }
+    void visitDeclRefExpr(DeclRefExpr &node) { add(node.location, node.identifier, node.resolvedDecl); }
+    void visitCallExpr(CallExpr &node) {
+        add(node.location, node.identifier, node.resolvedCallee);
+        for (Expr *arg : node.arguments) visit(*arg);
+    }
+    void visitBinaryExpr(BinaryExpr &node) {
+        visit(*node.left);
+        visit(*node.right);
+    }
+    void visitAssignmentExpr(AssignmentExpr &node) {
+        add(node.location, node.target, node.resolvedTarget);
+        visit(*node.value);
+    }
+};
+
+// Parses `text` and checks it with `threads` ParallelSema threads, or with
+// SemanticAnalysis::resolve if 0. Returns the bindings, or the diagnostics
+// if the check failed.
+std::string check(const std::string &text, unsigned threads) {
+    SourceManager sourceManager;
+    const SourceFile &file = sourceManager.addFile(
+        "input.al", llvm::MemoryBuffer::getMemBuffer(text, "input.al", /*RequiresNullTerminator=*/false));
+    ASTContext context;
+    TheLexer lexer{sourceManager, file};
+    Parser parser(lexer, context);
+    std::vector<FunctionDecl *> program = parser.parseProgram();
+
+    std::ostringstream diagnostics;
+    std::streambuf *old = std::cerr.rdbuf(diagnostics.rdbuf());
+    bool ok;
+    if (threads > 0) {
+        ParallelSema sema{program, sourceManager, threads};
+        ok = sema.resolve();
+    } else {
+        SemanticAnalysis sema(program, sourceManager);
+        ok = sema.resolve();
+    }
+    std::cerr.rdbuf(old);
+    if (!ok) return diagnostics.str();
+
+    std::string bindings;
+    ListBindings list(sourceManager, bindings);
+    for (FunctionDecl *function : program)
+        list.visit(*function);
+    return bindings;
+}
+
+// f<i> takes a parameter named after f<i+1>, the next function, and calls
+// f<i-1>, which the parameter of f<i-2> hid. The bodies span several
+// ParallelSema runs.
+std::pair<std::string, std::string> makeChain(unsigned n) {
+    std::string text = "func f0(x: int): int {\n    return x;\n}\n";
+    std::string expected = "2 x -> 1\n";
+    for (unsigned i = 1; i <= n; ++i) {
+        std::string line = std::to_string(3 * i + 1);
+        std::string param = "f" + std::to_string(i + 1);
+        text += "func f" + std::to_string(i) + "(" + param + ": int): int {\n"
+                "    return f" + std::to_string(i - 1) + "(" + param + ");\n}\n";
+        expected += std::to_string(3 * i + 2) + " f" + std::to_string(i - 1) + " -> " +
+                    std::to_string(3 * i - 2) + "\n" +
+                    std::to_string(3 * i + 2) + " " + param + " -> " + line + "\n";
+    }
+    return {text, expected};
+}
+}
+
+int main(int argc, const char **argv) {
+    cl::ParseCommandLineOptions(argc, argv, "Symbol table test\n");
+
+    std::vector<Case> all(std::begin(cases), std::end(cases));
+    auto [chain, chainExpected] = makeChain(numFunctions);
+    all.push_back({"parameters hide the next function, over many bodies", chain.c_str(),
+                   chainExpected.c_str()});
+
+    int failures = 0;
+    for (const Case &c : all) {
+        for (unsigned threads : {0u, 1u, 4u}) {
+            std::string actual = check(c.source, threads);
+            if (actual == c.expected) continue;
+            std::cerr << "FAIL: " << c.name << ", "
+                      << (threads ? std::to_string(threads) + " sema threads" : "resolve()")
+                      << "\n--- expected ---\n" << std::string(c.expected).substr(0, 2000)
+                      << "--- actual ---\n" << actual.substr(0, 2000);
+            ++failures;
+        }
+    }
+    if (failures) return 1;
+    std::cout << all.size() << " programs checked\n";
+    return 0;
+}